@@ -66,14 +66,18 @@ public slots:
             for (int i = 0; i < data.size() / fft_.size(); ++i) {
                 // A spectrum of convolution of two signals is multiplication
                 // of signals spectrums.
-                // Using inverted FFT to restore the result signal
-                QComplexSignal r = iFft_(fft_(fr) * pulseSpectrum_);
+                // Using inverted FFT to restore the result signal.
+                // All operations reuse spectrum_ buffer, so no memory is
+                // allocated after the first frame.
+                fft_.compute(fr, spectrum_);
+                spectrum_ *= pulseSpectrum_;
+                iFft_.transform(spectrum_);
 
                 // Normalize the result
-                r /= (double)pulse_.size() / fft_.size();
+                spectrum_ /= (double)pulse_.size() / fft_.size();
 
                 // Copy partial result to result signal
-                std::copy(r.begin(), r.end(), currentResultBegin);
+                std::copy(spectrum_.begin(), spectrum_.end(), currentResultBegin);
                 std::advance(currentResultBegin, fft_.size());
 
                 // Shifts the frame
@@ -100,6 +104,7 @@ public slots:
 
 private:
     QComplexSignal pulseSpectrum_;
+    QComplexSignal spectrum_;
     QFft fft_;
     QFft iFft_;
 };
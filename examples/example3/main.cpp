@@ -0,0 +1,153 @@
+#include "qdsp.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+using namespace dsp;
+
+// Constants
+constexpr int fftPowerMin = 4;
+constexpr int fftPowerMax = 22;
+// Approximate amount of samples processed for every FFT size
+constexpr qint64 samplesPerSize = 1 << 24;
+// Maximum deviation of vectorized results from the scalar path relative to
+// the spectrum peak
+constexpr double tolerance = 1e-12;
+
+// Reference radix-2 FFT, the kernel QFft used before radix-4 stages were
+// introduced. Kept here to compare both speed and results.
+class QReferenceFft
+{
+public:
+    explicit QReferenceFft(int power)
+        : power_(power), size_(1 << power), rotateMultiplers_(size_/2), buffer_(size_)
+    {
+        for (int i = 0; i < size_/2; i++) {
+            rotateMultiplers_[i] = QComplex(cos(2*M_PI/size_*i), -sin(2*M_PI/size_*i));
+        }
+    }
+
+    QComplexSignal compute(const QComplexSignal& signal)
+    {
+        std::copy(signal.begin(), signal.begin() + size_, buffer_.begin());
+        for (int i = power_; i > 0; --i) {
+            int pow2i = 1 << i;
+            for (int j = 0; j < size_/pow2i; ++j) {
+                for (int k = 0; k < pow2i/2; ++k) {
+                    QComplex a = buffer_[pow2i*j+k] + buffer_[pow2i*j+k+pow2i/2];
+                    QComplex b = rotateMultiplers_[k*1<<(power_-i)] *
+                            (buffer_[pow2i*j+k] - buffer_[pow2i*j+k+pow2i/2]);
+                    buffer_[pow2i*j+k] = a;
+                    buffer_[pow2i*j+k+pow2i/2] = b;
+                }
+            }
+        }
+        QComplexSignal result(size_, signal.clock());
+        for (int i = 0; i < size_; ++i) {
+            result[i] = buffer_[reverseBits(i)] / (double)size_;
+        }
+        return result;
+    }
+
+private:
+    int reverseBits(int number) const
+    {
+        int result = 0;
+        for (int i = 0; i < power_; ++i) {
+            result = (result << 1) | (number & 1);
+            number >>= 1;
+        }
+        return result;
+    }
+
+    int power_;
+    int size_;
+    QComplexSignal rotateMultiplers_;
+    QComplexSignal buffer_;
+};
+
+// Returns average time of one call in microseconds
+template<class Function>
+double measure(int repeats, Function function)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < repeats; ++i) {
+        function();
+    }
+    return timer.nsecsElapsed() / 1e3 / repeats;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+
+    out << qSetFieldWidth(10) << "size" << "radix-2" << "QFft"
+        << "speedup" << "max error" << qSetFieldWidth(0) << "\n";
+
+    for (int power = fftPowerMin; power <= fftPowerMax; ++power) {
+        int size = 1 << power;
+        int repeats = std::max<qint64>(samplesPerSize / size, 1);
+        QComplexSignal source = QComplexSignal::gaussianNoise(size);
+
+        QReferenceFft reference(power);
+        QFft fft(size);
+
+        QComplexSignal referenceResult = reference.compute(source);
+        QComplexSignal result = fft(source);
+        double error = peak(result - referenceResult);
+
+        double referenceTime = measure(repeats, [&](){ reference.compute(source); });
+        double time = measure(repeats, [&](){ fft(source); });
+
+        out << qSetFieldWidth(10) << size << referenceTime << time
+            << referenceTime / time << error << qSetFieldWidth(0) << "\n";
+        out.flush();
+    }
+
+    // Vectorized butterflies: every instruction set supported by the CPU is
+    // compared with the scalar implementation. Example 4 checks all FFT
+    // algorithms; here the deviation is only reported and limited.
+    const char* instructionSetNames[] = {"scalar", "SSE2", "AVX2", "AVX-512"};
+    SimdInstructionSet defaultInstructionSet = simdInstructionSet();
+    QVector<SimdInstructionSet> instructionSets;
+    for (auto instructionSet: {SimdInstructionSet::Scalar, SimdInstructionSet::SSE2,
+                               SimdInstructionSet::AVX2, SimdInstructionSet::AVX512}) {
+        if (isSimdInstructionSetSupported(instructionSet)) {
+            instructionSets.append(instructionSet);
+        }
+    }
+
+    out << "\n" << qSetFieldWidth(10) << "size";
+    for (SimdInstructionSet instructionSet: instructionSets) {
+        out << instructionSetNames[(int)instructionSet];
+    }
+    out << "max error" << qSetFieldWidth(0) << "\n";
+
+    bool passed = true;
+
+    for (int power = fftPowerMin; power <= fftPowerMax; ++power) {
+        int size = 1 << power;
+        int repeats = std::max<qint64>(samplesPerSize / size, 1);
+        QComplexSignal source = QComplexSignal::gaussianNoise(size);
+        QFft fft(size);
+
+        setSimdInstructionSet(SimdInstructionSet::Scalar);
+        QComplexSignal scalarResult = fft(source);
+
+        out << qSetFieldWidth(10) << size;
+        double error = 0;
+        for (SimdInstructionSet instructionSet: instructionSets) {
+            setSimdInstructionSet(instructionSet);
+            error = std::max(error, peak(fft(source) - scalarResult) / peak(scalarResult));
+            out << measure(repeats, [&](){ fft(source); });
+        }
+        out << error << qSetFieldWidth(0) << (error < tolerance ? "" : " FAIL") << "\n";
+        out.flush();
+        passed = passed && error < tolerance;
+    }
+    setSimdInstructionSet(defaultInstructionSet);
+    return passed ? 0 : 1;
+}
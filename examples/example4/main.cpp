@@ -0,0 +1,470 @@
+#include "qdsp.h"
+#include "processors.h"
+
+#include <QCoreApplication>
+#include <QTextStream>
+
+#include <atomic>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <new>
+
+using namespace dsp;
+
+// Allocation counter. Every operator new is counted; Qt containers allocate
+// with malloc, so with glibc the C allocation functions are counted as well.
+static std::atomic<qint64> allocationCount(0);
+
+void* operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+
+void* malloc(size_t size)
+{
+    ++allocationCount;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    ++allocationCount;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size)
+{
+    ++allocationCount;
+    return __libc_realloc(pointer, size);
+}
+}
+#endif
+
+// Constants
+constexpr int steadyStateCalls = 100;
+// Maximum deviation from the reference relative to the reference peak
+constexpr double doubleTolerance = 1e-12;
+constexpr double floatTolerance = 1e-5;
+// The Goertzel resonator accumulates rounding errors along the signal, the
+// more the lower the frequency is
+constexpr double goertzelTolerance = 1e-10;
+
+static QTextStream out(stdout);
+static int failureCount = 0;
+
+void check(const QString& name, bool passed)
+{
+    out << (passed ? "PASS " : "FAIL ") << name << "\n";
+    out.flush();
+    if (!passed) {
+        ++failureCount;
+    }
+}
+
+// Returns the number of allocations made by steadyStateCalls calls of
+// function after a warm-up call
+template<class Function>
+qint64 steadyStateAllocations(Function function)
+{
+    function();
+    qint64 before = allocationCount;
+    for (int i = 0; i < steadyStateCalls; ++i) {
+        function();
+    }
+    return allocationCount - before;
+}
+
+// Maximum deviation of result from reference relative to the reference peak.
+// Works for real and complex containers of any precision.
+template<class Result, class Reference>
+double relativeError(const Result& result, const Reference& reference)
+{
+    if (result.size() != reference.size()) {
+        return std::numeric_limits<double>::infinity();
+    }
+    double error = 0;
+    double norm = 0;
+    for (int i = 0; i < reference.size(); ++i) {
+        std::complex<double> expected(reference[i]);
+        error = std::max(error, std::abs(std::complex<double>(result[i]) - expected));
+        norm = std::max(norm, std::abs(expected));
+    }
+    return norm > 0 ? error / norm : error;
+}
+
+// Calls function(name) for every vectorized instruction set supported by
+// the CPU, and first for the scalar path if withScalar is set. Without it the
+// scalar path is the reference for the others.
+template<class Function>
+void forEachInstructionSet(Function function, bool withScalar = false)
+{
+    const QString names[] = {"scalar", "SSE2", "AVX2", "AVX-512"};
+    SimdInstructionSet defaultInstructionSet = simdInstructionSet();
+    for (auto instructionSet: {SimdInstructionSet::Scalar, SimdInstructionSet::SSE2,
+                               SimdInstructionSet::AVX2, SimdInstructionSet::AVX512}) {
+        QString name = names[(int)instructionSet];
+        if (instructionSet == SimdInstructionSet::Scalar && !withScalar) {
+            continue;
+        }
+        if (!isSimdInstructionSetSupported(instructionSet)) {
+            out << "SKIP " << name << " is not supported" << "\n";
+            continue;
+        }
+        setSimdInstructionSet(instructionSet);
+        function(name);
+    }
+    setSimdInstructionSet(defaultInstructionSet);
+}
+
+// Calls function(chunk, first) for consecutive frames of signal of varying
+// sizes, including empty ones
+template<class S, class Function>
+void forEachChunk(const S& signal, Function function)
+{
+    const int chunkSizes[] = {1, 7, 64, 0, 3, 250, 33, 128};
+    int first = 0;
+    for (int i = 0; first < signal.size(); ++i) {
+        int size = std::min(chunkSizes[i % std::size(chunkSizes)], signal.size() - first);
+        function(detail::QSignalFrame<S>(signal, size, first), first);
+        first += size;
+    }
+}
+
+// Compares FFT of precision T computed with every instruction set with the
+// scalar path: radix-4 (powers of 2), mixed radix Stockham and Bluestein
+// plans, real FFT of even and odd sizes and its inverse. The four-step
+// algorithm is used for complex FFT from 2^22 only, so the largest size is
+// checked with the forward complex FFT alone to keep the check fast.
+template<class T>
+void checkFftInstructionSets(const QString& precision, double tolerance)
+{
+    constexpr int fourStepSize = 1 << 22;
+    {
+        QComplexSignal signal = QComplexSignal::gaussianNoise(fourStepSize);
+        QBasicFft<T> fft(fourStepSize);
+        setSimdInstructionSet(SimdInstructionSet::Scalar);
+        auto spectrum = fft(signal);
+        forEachInstructionSet([&](const QString& name) {
+            check(QString("FFT ") + name + " " + precision + ", size " + QString::number(fourStepSize),
+                  relativeError(fft(signal), spectrum) < tolerance);
+        });
+    }
+
+    const int sizes[] = {4, 8, 64, 512, 4096, 1 << 15, 12, 360, 1000, 5040, 17, 1031, 2*4099};
+    for (int size: sizes) {
+        QString suffix = QString(" ") + precision + ", size " + QString::number(size);
+        QComplexSignal signal = QComplexSignal::gaussianNoise(size);
+        QRealSignal realSignal = QRealSignal::gaussianNoise(size);
+        QBasicFft<T> fft(size);
+        QBasicFft<T> inverseFft(size, true);
+        QBasicRealFft<T> realFft(size, true);
+
+        setSimdInstructionSet(SimdInstructionSet::Scalar);
+        auto spectrum = fft(signal);
+        auto inverseSpectrum = inverseFft(signal);
+        auto realSpectrum = realFft(realSignal);
+        auto restored = realFft.inverse(realSpectrum);
+
+        forEachInstructionSet([&](const QString& name) {
+            check(QString("FFT ") + name + suffix, relativeError(fft(signal), spectrum) < tolerance);
+            check(QString("inverse FFT ") + name + suffix,
+                  relativeError(inverseFft(signal), inverseSpectrum) < tolerance);
+            check(QString("real FFT ") + name + suffix, relativeError(realFft(realSignal), realSpectrum) < tolerance);
+            check(QString("inverse real FFT ") + name + suffix,
+                  relativeError(realFft.inverse(realSpectrum), restored) < tolerance);
+        });
+    }
+}
+
+// Direct form FIR filter: y[n] = sum of h[k]*x[n - k] with zero initial
+// state, the output of firFilter(coefficients, signal) of the signal size
+template<class T, class S>
+typename QFirFilter<T, S>::Result referenceFir(const T& coefficients, const S& signal)
+{
+    using Result = typename QFirFilter<T, S>::Result;
+    Result result(signal.size());
+    for (int n = 0; n < signal.size(); ++n) {
+        typename Result::value_type sum = 0;
+        for (int k = 0; k < coefficients.size() && k <= n; ++k) {
+            sum += coefficients[k]*signal[n - k];
+        }
+        result[n] = sum;
+    }
+    return result;
+}
+
+// Streaming QFirFilter and QFirDecimator with coefficients of type T and
+// signal of type S against the direct form reference with every instruction
+// set. Filter lengths cover the vector body and tails of the dot product
+// kernels; the signal is fed in chunks of varying size.
+template<class T, class S>
+void checkFirInstructionSets(const QString& types)
+{
+    using Result = typename QFirFilter<T, S>::Result;
+    constexpr int signalSize = 1000;
+    S signal = S::gaussianNoise(signalSize);
+    for (int taps: {1, 2, 3, 5, 8, 17, 64, 101}) {
+        T coefficients = T::gaussianNoise(taps);
+        Result reference = referenceFir(coefficients, signal);
+        QString suffix = QString(" ") + types + ", " + QString::number(taps) + " taps";
+
+        forEachInstructionSet([&](const QString& name) {
+            QFirFilter<T, S> filter(coefficients);
+            Result result(signalSize);
+            Result chunkResult;
+            forEachChunk(signal, [&](const detail::QSignalFrame<S>& chunk, int first) {
+                filter.process(chunk, chunkResult);
+                std::copy(chunkResult.begin(), chunkResult.end(), result.begin() + first);
+            });
+            check(QString("QFirFilter ") + name + suffix, relativeError(result, reference) < doubleTolerance);
+
+            for (int factor: {2, 3, 8}) {
+                QFirDecimator<T, S> decimator(coefficients, factor);
+                Result decimated(0);
+                Result expected((signalSize + factor - 1) / factor);
+                for (int i = 0; i < expected.size(); ++i) {
+                    expected[i] = reference[i*factor];
+                }
+                forEachChunk(signal, [&](const detail::QSignalFrame<S>& chunk, int) {
+                    decimator.process(chunk, chunkResult);
+                    int size = decimated.size();
+                    decimated.resize(size + chunkResult.size());
+                    std::copy(chunkResult.begin(), chunkResult.end(), decimated.begin() + size);
+                });
+                check(QString("QFirDecimator ") + name + suffix + ", factor " + QString::number(factor),
+                      relativeError(decimated, expected) < doubleTolerance);
+            }
+        }, true);
+    }
+}
+
+// Cascade of transposed direct form II sections applied to one channel
+template<class S>
+S referenceBiquadCascade(const QVector<QBiquad>& sections, const S& signal)
+{
+    S result = signal;
+    for (const QBiquad& section: sections) {
+        typename S::value_type w1 = 0;
+        typename S::value_type w2 = 0;
+        for (int i = 0; i < result.size(); ++i) {
+            typename S::value_type input = result[i];
+            typename S::value_type y = section.b0*input + w1;
+            w1 = section.b1*input + w2 - section.a1*y;
+            w2 = section.b2*input - section.a2*y;
+            result[i] = y;
+        }
+    }
+    return result;
+}
+
+// Streaming QBiquadCascade of 1 to 9 channels against the per-channel
+// reference with every instruction set. Channel counts cover full vector
+// registers and partial ones; a first order section (odd order Butterworth)
+// is included. The channels are fed in chunks of varying size.
+template<class S>
+void checkBiquadInstructionSets(const QString& type)
+{
+    using Frame = detail::QSignalFrame<S>;
+    constexpr int signalSize = 1000;
+    QVector<QBiquad> sections = butterworthLowPass(5, QFrequency(1e5), QFrequency(1e6));
+    sections += chebyshevBandPass(2, 0.5, QFrequency(5e4), QFrequency(2e5), QFrequency(1e6));
+    for (int channels = 1; channels <= 9; ++channels) {
+        QVector<S> inputs;
+        QVector<S> references;
+        for (int c = 0; c < channels; ++c) {
+            inputs.append(S::gaussianNoise(signalSize));
+            references.append(referenceBiquadCascade(sections, inputs.last()));
+        }
+        QString suffix = QString(" ") + type + ", " + QString::number(channels) + " channels";
+
+        forEachInstructionSet([&](const QString& name) {
+            QBiquadCascade<S> cascade(sections, channels);
+            QVector<S> results(channels, S(signalSize));
+            QVector<Frame> chunks;
+            QVector<S> chunkResults;
+            forEachChunk(inputs[0], [&](const Frame& chunk, int first) {
+                chunks.clear();
+                for (int c = 0; c < channels; ++c) {
+                    chunks.append(Frame(inputs[c], chunk.size(), first));
+                }
+                cascade.process(chunks, chunkResults);
+                for (int c = 0; c < channels; ++c) {
+                    std::copy(chunkResults[c].begin(), chunkResults[c].end(), results[c].begin() + first);
+                }
+            });
+            double error = 0;
+            for (int c = 0; c < channels; ++c) {
+                error = std::max(error, relativeError(results[c], references[c]));
+            }
+            check(QString("QBiquadCascade ") + name + suffix, error < doubleTolerance);
+        }, true);
+    }
+}
+
+// Spectrum of signal at frequency computed by definition with the forward
+// FFT normalization
+QComplex referenceSpectrum(const QRealSignal& signal, QFrequency frequency)
+{
+    QComplex sum = 0;
+    double normFrequency = frequency / signal.clock();
+    for (int n = 0; n < signal.size(); ++n) {
+        // The phase is reduced to one period first to keep it accurate
+        double turns = normFrequency*n;
+        sum += signal[n]*std::polar(1.0, -2*M_PI*(turns - std::floor(turns)));
+    }
+    return sum / (double)signal.size();
+}
+
+// QGoertzel against the spectrum computed by definition with every
+// instruction set. Frequency counts cover the four-register blocks, single
+// registers and the scalar tail of the resonator kernels; the frequencies are
+// arbitrary, not FFT bins.
+void checkGoertzelInstructionSets()
+{
+    QRealSignal signal = QRealSignal::gaussianNoise(1000, QFrequency(48e3));
+    for (int count: {1, 3, 8, 13, 32, 37, 70}) {
+        QVector<QFrequency> frequencies;
+        QComplexSignal reference(count);
+        for (int k = 0; k < count; ++k) {
+            frequencies.append(QFrequency(100 + 331.7*k));
+            reference[k] = referenceSpectrum(signal, frequencies[k]);
+        }
+        QGoertzel goertzel(frequencies, signal.clock());
+        QString suffix = QString(", ") + QString::number(count) + " frequencies";
+        forEachInstructionSet([&](const QString& name) {
+            check(QString("QGoertzel ") + name + suffix, relativeError(goertzel(signal), reference) < goertzelTolerance);
+        }, true);
+    }
+}
+
+// Brute-force O(N^2) DFT, the implementation dft() had before it was computed
+// through QFft: min(size, signal.size()) bins, forward transform scaled by
+// 1/N, inverse not scaled
+template<class T>
+QComplexSignal referenceDft(const T& signal, int size, bool inverted)
+{
+    int resultSize = std::min(size, signal.size());
+    QComplexSignal result(resultSize, signal.clock());
+    for (int i = 0; i < resultSize; ++i) {
+        QComplex sum = 0;
+        for (int k = 0; k < resultSize; ++k) {
+            // The index product is reduced first to keep the angle accurate
+            double angle = 2*M_PI*(((qint64)i*k) % resultSize) / resultSize;
+            sum += QComplex(signal[k])*std::polar(1.0, inverted ? angle : -angle);
+        }
+        result[i] = inverted ? sum : sum / (double)resultSize;
+    }
+    return result;
+}
+
+// dft() of real, complex and frame inputs against the brute-force reference
+// for prime, composite and power-of-two sizes, with the DFT size truncating
+// the signal and exceeding it
+void checkDft()
+{
+    for (int signalSize: {1, 2, 12, 17, 64, 360, 1000, 1031}) {
+        QRealSignal realSignal = QRealSignal::gaussianNoise(signalSize);
+        QComplexSignal complexSignal = QComplexSignal::gaussianNoise(signalSize);
+        complexSignal.setClock(QFrequency(1e6));
+        // The frame starts in the middle of a longer signal
+        QComplexSignal longSignal = QComplexSignal::gaussianNoise(2*signalSize + 3);
+        QComplexSignalFrame frame(longSignal, signalSize, signalSize/2 + 1);
+
+        for (int size: {signalSize, std::max(1, signalSize - signalSize/3), signalSize + 5}) {
+            for (bool inverted: {false, true}) {
+                QString suffix = QString(inverted ? " inverse" : " forward") + ", signal " +
+                        QString::number(signalSize) + ", size " + QString::number(size);
+                check(QString("dft of real signal") + suffix,
+                      relativeError(dft(realSignal, size, inverted), referenceDft(realSignal, size, inverted)) < doubleTolerance);
+                QComplexSignal result = dft(complexSignal, size, inverted);
+                check(QString("dft of complex signal") + suffix,
+                      relativeError(result, referenceDft(complexSignal, size, inverted)) < doubleTolerance &&
+                      result.clock() == complexSignal.clock());
+                check(QString("dft of frame") + suffix,
+                      relativeError(dft(frame, size, inverted), referenceDft(frame, size, inverted)) < doubleTolerance);
+            }
+        }
+    }
+}
+
+void checkAllocations()
+{
+    for (int size: {1024, 1000, 1031}) {
+        QString suffix = QString(" without allocations, size ") + QString::number(size);
+        QComplexSignal signal = QComplexSignal::gaussianNoise(size);
+        QRealSignal realSignal = QRealSignal::gaussianNoise(size);
+
+        QFft fft(size);
+        QComplexSignal spectrum;
+        check(QString("QFft::compute") + suffix,
+              steadyStateAllocations([&]() { fft.compute(signal, spectrum); }) == 0);
+        check(QString("QFft::transform") + suffix,
+              steadyStateAllocations([&]() { fft.transform(spectrum); }) == 0);
+
+        QRealFft realFft(size);
+        QComplexSignal halfSpectrum;
+        QRealSignal restored;
+        check(QString("QRealFft::compute") + suffix,
+              steadyStateAllocations([&]() { realFft.compute(realSignal, halfSpectrum); }) == 0);
+        check(QString("QRealFft::inverse") + suffix,
+              steadyStateAllocations([&]() { realFft.inverse(halfSpectrum, restored); }) == 0);
+    }
+
+    QVector<QFrequency> frequencies;
+    for (int k = 0; k < 37; ++k) {
+        frequencies.append(QFrequency(100 + 331.7*k));
+    }
+    QRealSignal signal = QRealSignal::gaussianNoise(4096, QFrequency(48e3));
+    QGoertzel goertzel(frequencies, signal.clock());
+    QComplexSignal spectrum;
+    check("QGoertzel::compute without allocations",
+          steadyStateAllocations([&]() { goertzel.compute(signal, spectrum); }) == 0);
+
+    QFrequencyDomainProcessor processor;
+    processor.setFftSize(1024);
+    processor.setPulse(QComplexSignal::gaussianNoise(100));
+    QComplexSignal data = QComplexSignal::gaussianNoise(16*1024);
+    check("QFrequencyDomainProcessor::process without allocations",
+          steadyStateAllocations([&]() { processor.process(data); }) == 0);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    checkAllocations();
+    checkDft();
+    checkFftInstructionSets<double>("double", doubleTolerance);
+    checkFftInstructionSets<float>("float", floatTolerance);
+    checkFirInstructionSets<QRealSignal, QRealSignal>("real taps, real signal");
+    checkFirInstructionSets<QRealSignal, QComplexSignal>("real taps, complex signal");
+    checkFirInstructionSets<QComplexSignal, QRealSignal>("complex taps, real signal");
+    checkFirInstructionSets<QComplexSignal, QComplexSignal>("complex taps, complex signal");
+    checkBiquadInstructionSets<QRealSignal>("real signal");
+    checkBiquadInstructionSets<QComplexSignal>("complex signal");
+    checkGoertzelInstructionSets();
+
+    out << (failureCount == 0 ? "All checks passed" : "Some checks failed") << "\n";
+    return failureCount == 0 ? 0 : 1;
+}
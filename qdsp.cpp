@@ -1,8 +1,17 @@
 #include "qdsp.h"
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
 #include <limits>
 #include <math.h>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
 
 #include <QDebug>
 #include <QRandomGenerator>
@@ -363,74 +372,2514 @@ QWaveformFileInfo QWaveformFileInfo::analyse(const QString& fileName)
     return detail::readWaveformHeader(file);
 }
 
-QFft::QFft(int fftSize, bool inverted)
-    : fftPower_(floor(log2(fftSize))), inverted_(inverted)
+namespace {
+
+QVector<int> makeBitReversalTable(int power)
+{
+    QVector<int> result(1 << power);
+    result[0] = 0;
+    for (int i = 1; i < result.size(); ++i) {
+        result[i] = (result[i >> 1] >> 1) | ((i & 1) << (power - 1));
+    }
+    return result;
+}
+
+} // namespace
+
+detail::QBitReversal::QBitReversal(int power)
+    : power_(power), blocked_(power >= minBlockedPower_)
+{
+    if (power < 0) {
+        throw std::invalid_argument("FFT power must be positive");
+    }
+    if (power == 0) {
+        return;
+    }
+    // Индекс при поблочной перестановке делится на старшие, средние и младшие
+    // биты, таблица строится только для средних
+    table_ = makeBitReversalTable(blocked_ ? power - 2*blockPower_ : power);
+    if (blocked_) {
+        blockTable_ = makeBitReversalTable(blockPower_);
+    }
+}
+
+int detail::QBitReversal::reversed(int index) const
+{
+    if (!blocked_) {
+        return table_[index];
+    }
+    int highShift = power_ - blockPower_;
+    int blockMask = (1 << blockPower_) - 1;
+    return blockTable_[index & blockMask] << highShift |
+            table_[(index >> blockPower_) & (table_.size() - 1)] << blockPower_ |
+            blockTable_[index >> highShift];
+}
+
+template<class Complex>
+void detail::QBitReversal::copy(const Complex* source, Complex* destination) const
+{
+    int size = this->size();
+    if (!blocked_) {
+        for (int i = 0; i < size; ++i) {
+            destination[i] = source[table_[i]];
+        }
+        return;
+    }
+    constexpr int blockSize = 1 << blockPower_;
+    int highShift = power_ - blockPower_;
+    Complex block[blockSize*blockSize];
+    for (int middle = 0; middle < table_.size(); ++middle) {
+        // Чтение: строки с одинаковыми старшими битами
+        const Complex* s = source + (middle << blockPower_);
+        for (int high = 0; high < blockSize; ++high) {
+            std::copy_n(s + (high << highShift), blockSize,
+                        block + blockTable_[high]*blockSize);
+        }
+        // Запись: строки с одинаковыми младшими битами исходного индекса
+        Complex* d = destination + (table_[middle] << blockPower_);
+        for (int low = 0; low < blockSize; ++low) {
+            Complex* row = d + (blockTable_[low] << highShift);
+            for (int high = 0; high < blockSize; ++high) {
+                row[high] = block[high*blockSize + low];
+            }
+        }
+    }
+}
+
+template<class Complex>
+void detail::QBitReversal::apply(Complex* data) const
+{
+    int size = this->size();
+    for (int i = 0; i < size; ++i) {
+        int j = this->reversed(i);
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+}
+
+template void detail::QBitReversal::copy(const std::complex<float>*, std::complex<float>*) const;
+template void detail::QBitReversal::copy(const std::complex<double>*, std::complex<double>*) const;
+template void detail::QBitReversal::apply(std::complex<float>*) const;
+template void detail::QBitReversal::apply(std::complex<double>*) const;
+
+namespace {
+
+// std::complex::operator* проверяет результат на NaN и не встраивается
+template<class T>
+inline std::complex<T> multiply(std::complex<T> a, std::complex<T> b)
+{
+    return std::complex<T>(a.real()*b.real() - a.imag()*b.imag(),
+                           a.real()*b.imag() + a.imag()*b.real());
+}
+
+// Умножение на -i
+template<class T>
+inline std::complex<T> rotate(std::complex<T> a)
+{
+    return std::complex<T>(a.imag(), -a.real());
+}
+
+// Множители вычисляются с двойной точностью независимо от T
+template<class T>
+inline std::complex<T> exponent(double phase)
+{
+    return std::complex<T>(cos(phase), sin(phase));
+}
+
+bool isPowerOfTwo(int size)
+{
+    return size > 0 && (size & (size - 1)) == 0;
+}
+
+// Каскад алгоритма Стокхэма с прореживанием по частоте: n - размерность
+// текущего каскада, m = n/radix, s - шаг между отсчётами. Перестановка
+// результата не требуется, но вход и выход каскада не должны совпадать.
+template<int radix, class T>
+void mixedRadixStage(const std::complex<T>* x, std::complex<T>* y, int m, int s, const std::complex<T>* w)
+{
+    using Complex = std::complex<T>;
+    // Для нечётных оснований используется симметрия ДПФ:
+    // B[u] = a[0] + sum((a[t] + a[radix-t])*cos(2*pi*t*u/radix)) -
+    //        i*sum((a[t] - a[radix-t])*sin(2*pi*t*u/radix))
+    constexpr int half = radix/2;
+    static const auto table = []() {
+        std::array<std::pair<T, T>, radix*radix> result;
+        for (int i = 0; i < radix*radix; ++i) {
+            result[i] = {cos(2*M_PI*i/radix), sin(2*M_PI*i/radix)};
+        }
+        return result;
+    }();
+    for (int p = 0; p < m; ++p) {
+        const Complex* wp = w + p*(radix - 1);
+        for (int q = 0; q < s; ++q) {
+            Complex a[radix];
+            Complex b[radix];
+            for (int t = 0; t < radix; ++t) {
+                a[t] = x[q + s*(p + t*m)];
+            }
+            if constexpr (radix == 2) {
+                b[0] = a[0] + a[1];
+                b[1] = a[0] - a[1];
+            } else if constexpr (radix == 4) {
+                Complex s02 = a[0] + a[2];
+                Complex d02 = a[0] - a[2];
+                Complex s13 = a[1] + a[3];
+                Complex d13 = rotate(a[1] - a[3]);
+                b[0] = s02 + s13;
+                b[1] = d02 + d13;
+                b[2] = s02 - s13;
+                b[3] = d02 - d13;
+            } else {
+                Complex sums[half + 1];
+                Complex differences[half + 1];
+                b[0] = a[0];
+                for (int t = 1; t <= half; ++t) {
+                    sums[t] = a[t] + a[radix - t];
+                    differences[t] = a[t] - a[radix - t];
+                    b[0] += sums[t];
+                }
+                for (int u = 1; u <= half; ++u) {
+                    Complex re = a[0];
+                    Complex im;
+                    for (int t = 1; t <= half; ++t) {
+                        const auto& cs = table[(t*u) % radix];
+                        re += sums[t] * cs.first;
+                        im += differences[t] * cs.second;
+                    }
+                    b[u] = re + rotate(im);
+                    b[radix - u] = re - rotate(im);
+                }
+            }
+            Complex* out = y + q + s*radix*p;
+            out[0] = b[0];
+            for (int u = 1; u < radix; ++u) {
+                out[s*u] = multiply(b[u], wp[u - 1]);
+            }
+        }
+    }
+}
+
+// Бабочки radix-4 одного блока каскада: x - начало блока из 4*quarter
+// отсчётов, w - таблица каскада: W^k, W^2k, W^3k по quarter множителей.
+// Векторизованные реализации обрабатывают хвост блока скалярной.
+template<class T>
+void radix4Butterflies(std::complex<T>* x, int quarter, const std::complex<T>* w, int begin = 0)
+{
+    std::complex<T>* x1 = x + quarter;
+    std::complex<T>* x2 = x1 + quarter;
+    std::complex<T>* x3 = x2 + quarter;
+    for (int k = begin; k < quarter; ++k) {
+        std::complex<T> a = x[k] + x2[k];
+        std::complex<T> b = x[k] - x2[k];
+        std::complex<T> c = x1[k] + x3[k];
+        std::complex<T> d = rotate(x1[k] - x3[k]);
+        x[k] = a + c;
+        x1[k] = multiply(a - c, w[quarter + k]);
+        x2[k] = multiply(b + d, w[k]);
+        x3[k] = multiply(b - d, w[2*quarter + k]);
+    }
+}
+
+// Скалярные произведения taps[0..n) и x[j*step..j*step + n), j = 0..count-1.
+// Суммы произведений с чётными и нечётными индексами записываются в
+// sums[2*j] и sums[2*j + 1]: для комплексных отсчётов, уложенных парами
+// (re, im), это действительная и мнимая части.
+template<class T>
+void dotProducts(const T* taps, const T* x, int n, int step, int count, T* sums)
+{
+    for (int j = 0; j < count; ++j) {
+        const T* y = x + (qint64)j*step;
+        T even = 0;
+        T odd = 0;
+        int i = 0;
+        for (; i + 1 < n; i += 2) {
+            even += taps[i]*y[i];
+            odd += taps[i + 1]*y[i + 1];
+        }
+        if (i < n) {
+            even += taps[i]*y[i];
+        }
+        sums[2*j] = even;
+        sums[2*j + 1] = odd;
+    }
+}
+
+// Каскад звеньев в транспонированной второй прямой форме для lanes каналов,
+// отсчёты которых чередуются: data[t*lanes + lane]
+template<class T>
+void biquadCascade(const QBiquad* sections, int sectionCount, T* state, T* data, int samples, int lanes)
+{
+    for (int s = 0; s < sectionCount; ++s) {
+        // Коэффициенты копируются: запись в data могла бы их изменить
+        const T b0 = sections[s].b0;
+        const T b1 = sections[s].b1;
+        const T b2 = sections[s].b2;
+        const T a1 = sections[s].a1;
+        const T a2 = sections[s].a2;
+        T* z1 = state + 2*s*lanes;
+        T* z2 = z1 + lanes;
+        for (int lane = 0; lane < lanes; ++lane) {
+            T w1 = z1[lane];
+            T w2 = z2[lane];
+            T* x = data + lane;
+            for (int t = 0; t < samples; ++t, x += lanes) {
+                T input = *x;
+                T y = b0*input + w1;
+                w1 = b1*input + w2 - a1*y;
+                w2 = b2*input - a2*y;
+                *x = y;
+            }
+            z1[lane] = w1;
+            z2[lane] = w2;
+        }
+    }
+}
+
+// Резонаторы Гёрцеля для count частот; порядок операций совпадает с
+// векторизованными версиями
+template<class T>
+void goertzelResonators(const T* coefficients, T* s1, T* s2, int count, const T* signal, int size)
+{
+    for (int k = 0; k < count; ++k) {
+        const T c = coefficients[k];
+        T u1 = s1[k];
+        T u2 = s2[k];
+        for (int n = 0; n < size; ++n) {
+            T s0 = c*u1 + (signal[n] - u2);
+            u2 = u1;
+            u1 = s0;
+        }
+        s1[k] = u1;
+        s2[k] = u2;
+    }
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QDSP_X86_SIMD
+
+// Операции над комплексными отсчётами, уложенными в векторный регистр
+// парами (re, im). Функции каждого набора команд компилируются с
+// соответствующим атрибутом target, поэтому библиотека собирается без
+// специальных ключей компилятора, а выбор набора выполняется при работе.
+template<class T> struct Sse2Ops;
+template<class T> struct Avx2Ops;
+template<class T> struct Avx512Ops;
+
+#define QDSP_SSE2 __attribute__((target("sse2")))
+#define QDSP_AVX2 __attribute__((target("avx2,fma")))
+#define QDSP_AVX512 __attribute__((target("avx512f,avx2,fma")))
+
+template<> struct Sse2Ops<double> {
+    using Vector = __m128d;
+    static constexpr int width = 1;
+    QDSP_SSE2 static Vector load(const std::complex<double>* p) { return _mm_loadu_pd((const double*)p); }
+    QDSP_SSE2 static void store(std::complex<double>* p, Vector a) { _mm_storeu_pd((double*)p, a); }
+    QDSP_SSE2 static Vector add(Vector a, Vector b) { return _mm_add_pd(a, b); }
+    QDSP_SSE2 static Vector sub(Vector a, Vector b) { return _mm_sub_pd(a, b); }
+    // Действительные отсчёты, 2*width в регистре
+    QDSP_SSE2 static Vector load(const double* p) { return _mm_loadu_pd(p); }
+    QDSP_SSE2 static void store(double* p, Vector a) { _mm_storeu_pd(p, a); }
+    QDSP_SSE2 static Vector zero() { return _mm_setzero_pd(); }
+    QDSP_SSE2 static Vector broadcast(double a) { return _mm_set1_pd(a); }
+    QDSP_SSE2 static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+    QDSP_SSE2 static Vector multiply(Vector a, Vector w)
+    {
+        Vector re = _mm_unpacklo_pd(w, w);
+        Vector im = _mm_unpackhi_pd(w, w);
+        Vector swapped = _mm_shuffle_pd(a, a, 1);
+        return _mm_add_pd(_mm_mul_pd(a, re), _mm_xor_pd(_mm_mul_pd(swapped, im), _mm_set_pd(0.0, -0.0)));
+    }
+    QDSP_SSE2 static Vector rotate(Vector a)
+    { return _mm_xor_pd(_mm_shuffle_pd(a, a, 1), _mm_set_pd(-0.0, 0.0)); }
+};
+
+template<> struct Sse2Ops<float> {
+    using Vector = __m128;
+    static constexpr int width = 2;
+    QDSP_SSE2 static Vector load(const std::complex<float>* p) { return _mm_loadu_ps((const float*)p); }
+    QDSP_SSE2 static void store(std::complex<float>* p, Vector a) { _mm_storeu_ps((float*)p, a); }
+    QDSP_SSE2 static Vector add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+    QDSP_SSE2 static Vector sub(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+    QDSP_SSE2 static Vector load(const float* p) { return _mm_loadu_ps(p); }
+    QDSP_SSE2 static void store(float* p, Vector a) { _mm_storeu_ps(p, a); }
+    QDSP_SSE2 static Vector zero() { return _mm_setzero_ps(); }
+    QDSP_SSE2 static Vector broadcast(float a) { return _mm_set1_ps(a); }
+    QDSP_SSE2 static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    QDSP_SSE2 static Vector multiply(Vector a, Vector w)
+    {
+        Vector re = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 0, 0));
+        Vector im = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 1, 1));
+        Vector swapped = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm_add_ps(_mm_mul_ps(a, re),
+                          _mm_xor_ps(_mm_mul_ps(swapped, im), _mm_set_ps(0.0f, -0.0f, 0.0f, -0.0f)));
+    }
+    QDSP_SSE2 static Vector rotate(Vector a)
+    {
+        return _mm_xor_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+                          _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f));
+    }
+};
+
+template<> struct Avx2Ops<double> {
+    using Vector = __m256d;
+    static constexpr int width = 2;
+    QDSP_AVX2 static Vector load(const std::complex<double>* p) { return _mm256_loadu_pd((const double*)p); }
+    QDSP_AVX2 static void store(std::complex<double>* p, Vector a) { _mm256_storeu_pd((double*)p, a); }
+    QDSP_AVX2 static Vector add(Vector a, Vector b) { return _mm256_add_pd(a, b); }
+    QDSP_AVX2 static Vector sub(Vector a, Vector b) { return _mm256_sub_pd(a, b); }
+    QDSP_AVX2 static Vector load(const double* p) { return _mm256_loadu_pd(p); }
+    QDSP_AVX2 static void store(double* p, Vector a) { _mm256_storeu_pd(p, a); }
+    QDSP_AVX2 static Vector zero() { return _mm256_setzero_pd(); }
+    QDSP_AVX2 static Vector broadcast(double a) { return _mm256_set1_pd(a); }
+    QDSP_AVX2 static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm256_fmadd_pd(a, b, c); }
+    QDSP_AVX2 static Vector multiply(Vector a, Vector w)
+    {
+        Vector swapped = _mm256_permute_pd(a, 0x5);
+        return _mm256_fmaddsub_pd(a, _mm256_movedup_pd(w),
+                                  _mm256_mul_pd(swapped, _mm256_permute_pd(w, 0xF)));
+    }
+    QDSP_AVX2 static Vector rotate(Vector a)
+    { return _mm256_xor_pd(_mm256_permute_pd(a, 0x5), _mm256_set_pd(-0.0, 0.0, -0.0, 0.0)); }
+};
+
+template<> struct Avx2Ops<float> {
+    using Vector = __m256;
+    static constexpr int width = 4;
+    QDSP_AVX2 static Vector load(const std::complex<float>* p) { return _mm256_loadu_ps((const float*)p); }
+    QDSP_AVX2 static void store(std::complex<float>* p, Vector a) { _mm256_storeu_ps((float*)p, a); }
+    QDSP_AVX2 static Vector add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+    QDSP_AVX2 static Vector sub(Vector a, Vector b) { return _mm256_sub_ps(a, b); }
+    QDSP_AVX2 static Vector load(const float* p) { return _mm256_loadu_ps(p); }
+    QDSP_AVX2 static void store(float* p, Vector a) { _mm256_storeu_ps(p, a); }
+    QDSP_AVX2 static Vector zero() { return _mm256_setzero_ps(); }
+    QDSP_AVX2 static Vector broadcast(float a) { return _mm256_set1_ps(a); }
+    QDSP_AVX2 static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm256_fmadd_ps(a, b, c); }
+    QDSP_AVX2 static Vector multiply(Vector a, Vector w)
+    {
+        Vector swapped = _mm256_permute_ps(a, 0xB1);
+        return _mm256_fmaddsub_ps(a, _mm256_moveldup_ps(w),
+                                  _mm256_mul_ps(swapped, _mm256_movehdup_ps(w)));
+    }
+    QDSP_AVX2 static Vector rotate(Vector a)
+    {
+        return _mm256_xor_ps(_mm256_permute_ps(a, 0xB1),
+                             _mm256_set_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f));
+    }
+};
+
+template<> struct Avx512Ops<double> {
+    using Vector = __m512d;
+    static constexpr int width = 4;
+    QDSP_AVX512 static Vector load(const std::complex<double>* p) { return _mm512_loadu_pd((const double*)p); }
+    QDSP_AVX512 static void store(std::complex<double>* p, Vector a) { _mm512_storeu_pd((double*)p, a); }
+    QDSP_AVX512 static Vector add(Vector a, Vector b) { return _mm512_add_pd(a, b); }
+    QDSP_AVX512 static Vector sub(Vector a, Vector b) { return _mm512_sub_pd(a, b); }
+    QDSP_AVX512 static Vector load(const double* p) { return _mm512_loadu_pd(p); }
+    QDSP_AVX512 static void store(double* p, Vector a) { _mm512_storeu_pd(p, a); }
+    QDSP_AVX512 static Vector zero() { return _mm512_setzero_pd(); }
+    QDSP_AVX512 static Vector broadcast(double a) { return _mm512_set1_pd(a); }
+    QDSP_AVX512 static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm512_fmadd_pd(a, b, c); }
+    QDSP_AVX512 static Vector multiply(Vector a, Vector w)
+    {
+        // shuffle вместо permute и movedup: одинаковые инструкции, но без
+        // ложных предупреждений GCC о неинициализированных операндах
+        Vector swapped = _mm512_shuffle_pd(a, a, 0x55);
+        return _mm512_fmaddsub_pd(a, _mm512_shuffle_pd(w, w, 0x00),
+                                  _mm512_mul_pd(swapped, _mm512_shuffle_pd(w, w, 0xFF)));
+    }
+    QDSP_AVX512 static Vector rotate(Vector a)
+    {
+        // Смена знака мнимых частей: xor для __m512d требует AVX-512DQ
+        __m512i sign = _mm512_castpd_si512(_mm512_set_pd(-0.0, 0.0, -0.0, 0.0, -0.0, 0.0, -0.0, 0.0));
+        return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_mm512_shuffle_pd(a, a, 0x55)), sign));
+    }
+};
+
+template<> struct Avx512Ops<float> {
+    using Vector = __m512;
+    static constexpr int width = 8;
+    QDSP_AVX512 static Vector load(const std::complex<float>* p) { return _mm512_loadu_ps((const float*)p); }
+    QDSP_AVX512 static void store(std::complex<float>* p, Vector a) { _mm512_storeu_ps((float*)p, a); }
+    QDSP_AVX512 static Vector add(Vector a, Vector b) { return _mm512_add_ps(a, b); }
+    QDSP_AVX512 static Vector sub(Vector a, Vector b) { return _mm512_sub_ps(a, b); }
+    QDSP_AVX512 static Vector load(const float* p) { return _mm512_loadu_ps(p); }
+    QDSP_AVX512 static void store(float* p, Vector a) { _mm512_storeu_ps(p, a); }
+    QDSP_AVX512 static Vector zero() { return _mm512_setzero_ps(); }
+    QDSP_AVX512 static Vector broadcast(float a) { return _mm512_set1_ps(a); }
+    QDSP_AVX512 static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm512_fmadd_ps(a, b, c); }
+    QDSP_AVX512 static Vector multiply(Vector a, Vector w)
+    {
+        Vector swapped = _mm512_shuffle_ps(a, a, 0xB1);
+        return _mm512_fmaddsub_ps(a, _mm512_shuffle_ps(w, w, 0xA0),
+                                  _mm512_mul_ps(swapped, _mm512_shuffle_ps(w, w, 0xF5)));
+    }
+    QDSP_AVX512 static Vector rotate(Vector a)
+    {
+        __m512i sign = _mm512_castps_si512(_mm512_set_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f,
+                                                         -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f));
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_shuffle_ps(a, a, 0xB1)), sign));
+    }
+};
+
+// Тело цикла одинаково для всех наборов команд, но функция, в которую
+// встраиваются операции, должна иметь тот же атрибут target, что и они
+#define QDSP_RADIX4_BUTTERFLIES(Ops) \
+    std::complex<T>* x1 = x + quarter; \
+    std::complex<T>* x2 = x1 + quarter; \
+    std::complex<T>* x3 = x2 + quarter; \
+    int k = 0; \
+    for (; k + Ops::width <= quarter; k += Ops::width) { \
+        auto x0k = Ops::load(x + k); \
+        auto x1k = Ops::load(x1 + k); \
+        auto x2k = Ops::load(x2 + k); \
+        auto x3k = Ops::load(x3 + k); \
+        auto a = Ops::add(x0k, x2k); \
+        auto b = Ops::sub(x0k, x2k); \
+        auto c = Ops::add(x1k, x3k); \
+        auto d = Ops::rotate(Ops::sub(x1k, x3k)); \
+        Ops::store(x + k, Ops::add(a, c)); \
+        Ops::store(x1 + k, Ops::multiply(Ops::sub(a, c), Ops::load(w + quarter + k))); \
+        Ops::store(x2 + k, Ops::multiply(Ops::add(b, d), Ops::load(w + k))); \
+        Ops::store(x3 + k, Ops::multiply(Ops::sub(b, d), Ops::load(w + 2*quarter + k))); \
+    } \
+    radix4Butterflies(x, quarter, w, k);
+
+template<class T>
+QDSP_SSE2 void radix4ButterfliesSse2(std::complex<T>* x, int quarter, const std::complex<T>* w)
+{ QDSP_RADIX4_BUTTERFLIES(Sse2Ops<T>) }
+
+template<class T>
+QDSP_AVX2 void radix4ButterfliesAvx2(std::complex<T>* x, int quarter, const std::complex<T>* w)
+{ QDSP_RADIX4_BUTTERFLIES(Avx2Ops<T>) }
+
+template<class T>
+QDSP_AVX512 void radix4ButterfliesAvx512(std::complex<T>* x, int quarter, const std::complex<T>* w)
+{ QDSP_RADIX4_BUTTERFLIES(Avx512Ops<T>) }
+
+#undef QDSP_RADIX4_BUTTERFLIES
+
+// Четыре независимых накопителя скрывают задержку умножения-сложения.
+// Хвост короче регистра досчитывается в той же функции: вызов функции без
+// атрибута target приводит к смене режима AVX/SSE на каждом отсчёте.
+#define QDSP_DOT_PRODUCTS(Ops) \
+    constexpr int lanes = 2*Ops::width; \
+    int vectorEnd = n - n % lanes; \
+    for (int j = 0; j < count; ++j) { \
+        const T* y = x + (qint64)j*step; \
+        auto s0 = Ops::zero(); \
+        auto s1 = Ops::zero(); \
+        auto s2 = Ops::zero(); \
+        auto s3 = Ops::zero(); \
+        int i = 0; \
+        for (; i + 4*lanes <= n; i += 4*lanes) { \
+            s0 = Ops::multiplyAdd(Ops::load(taps + i), Ops::load(y + i), s0); \
+            s1 = Ops::multiplyAdd(Ops::load(taps + i + lanes), Ops::load(y + i + lanes), s1); \
+            s2 = Ops::multiplyAdd(Ops::load(taps + i + 2*lanes), Ops::load(y + i + 2*lanes), s2); \
+            s3 = Ops::multiplyAdd(Ops::load(taps + i + 3*lanes), Ops::load(y + i + 3*lanes), s3); \
+        } \
+        for (; i < vectorEnd; i += lanes) { \
+            s0 = Ops::multiplyAdd(Ops::load(taps + i), Ops::load(y + i), s0); \
+        } \
+        T lane[lanes]; \
+        Ops::store(lane, Ops::add(Ops::add(s0, s1), Ops::add(s2, s3))); \
+        T even = 0; \
+        T odd = 0; \
+        for (int k = 0; k < lanes; k += 2) { \
+            even += lane[k]; \
+            odd += lane[k + 1]; \
+        } \
+        for (; i + 1 < n; i += 2) { \
+            even += taps[i]*y[i]; \
+            odd += taps[i + 1]*y[i + 1]; \
+        } \
+        if (i < n) { \
+            even += taps[i]*y[i]; \
+        } \
+        sums[2*j] = even; \
+        sums[2*j + 1] = odd; \
+    }
+
+template<class T>
+QDSP_SSE2 void dotProductsSse2(const T* taps, const T* x, int n, int step, int count, T* sums)
+{ QDSP_DOT_PRODUCTS(Sse2Ops<T>) }
+
+template<class T>
+QDSP_AVX2 void dotProductsAvx2(const T* taps, const T* x, int n, int step, int count, T* sums)
+{ QDSP_DOT_PRODUCTS(Avx2Ops<T>) }
+
+template<class T>
+QDSP_AVX512 void dotProductsAvx512(const T* taps, const T* x, int n, int step, int count, T* sums)
+{ QDSP_DOT_PRODUCTS(Avx512Ops<T>) }
+
+#undef QDSP_DOT_PRODUCTS
+
+// Каждый элемент регистра - отдельный канал, поэтому рекурсия по отсчётам
+// не мешает векторизации. Рекурсия ограничена задержкой двух умножений-
+// сложений на отсчёт, поэтому при достаточном числе каналов одновременно
+// обрабатываются четыре независимых регистра. Остаток каналов, не
+// заполняющий регистр, досчитывается в той же функции по той же причине, что
+// и в скалярных произведениях.
+#define QDSP_BIQUAD_STEP(Ops, offset, w1, w2) { \
+        auto input = Ops::load(x + offset); \
+        auto y = Ops::multiplyAdd(b0, input, w1); \
+        w1 = Ops::multiplyAdd(a1, y, Ops::multiplyAdd(b1, input, w2)); \
+        w2 = Ops::multiplyAdd(a2, y, Ops::multiplyAdd(b2, input, Ops::zero())); \
+        Ops::store(x + offset, y); \
+    }
+
+#define QDSP_BIQUAD_CASCADE(Ops) \
+    constexpr int width = 2*Ops::width; \
+    for (int s = 0; s < sectionCount; ++s) { \
+        const T c0 = sections[s].b0; \
+        const T c1 = sections[s].b1; \
+        const T c2 = sections[s].b2; \
+        const T d1 = sections[s].a1; \
+        const T d2 = sections[s].a2; \
+        T* z1 = state + 2*s*lanes; \
+        T* z2 = z1 + lanes; \
+        auto b0 = Ops::broadcast(c0); \
+        auto b1 = Ops::broadcast(c1); \
+        auto b2 = Ops::broadcast(c2); \
+        auto a1 = Ops::broadcast(-d1); \
+        auto a2 = Ops::broadcast(-d2); \
+        int lane = 0; \
+        for (; lane + 4*width <= lanes; lane += 4*width) { \
+            auto u1 = Ops::load(z1 + lane); \
+            auto u2 = Ops::load(z2 + lane); \
+            auto v1 = Ops::load(z1 + lane + width); \
+            auto v2 = Ops::load(z2 + lane + width); \
+            auto w1 = Ops::load(z1 + lane + 2*width); \
+            auto w2 = Ops::load(z2 + lane + 2*width); \
+            auto r1 = Ops::load(z1 + lane + 3*width); \
+            auto r2 = Ops::load(z2 + lane + 3*width); \
+            T* x = data + lane; \
+            for (int t = 0; t < samples; ++t, x += lanes) { \
+                QDSP_BIQUAD_STEP(Ops, 0, u1, u2) \
+                QDSP_BIQUAD_STEP(Ops, width, v1, v2) \
+                QDSP_BIQUAD_STEP(Ops, 2*width, w1, w2) \
+                QDSP_BIQUAD_STEP(Ops, 3*width, r1, r2) \
+            } \
+            Ops::store(z1 + lane, u1); \
+            Ops::store(z2 + lane, u2); \
+            Ops::store(z1 + lane + width, v1); \
+            Ops::store(z2 + lane + width, v2); \
+            Ops::store(z1 + lane + 2*width, w1); \
+            Ops::store(z2 + lane + 2*width, w2); \
+            Ops::store(z1 + lane + 3*width, r1); \
+            Ops::store(z2 + lane + 3*width, r2); \
+        } \
+        for (; lane + width <= lanes; lane += width) { \
+            auto w1 = Ops::load(z1 + lane); \
+            auto w2 = Ops::load(z2 + lane); \
+            T* x = data + lane; \
+            for (int t = 0; t < samples; ++t, x += lanes) { \
+                QDSP_BIQUAD_STEP(Ops, 0, w1, w2) \
+            } \
+            Ops::store(z1 + lane, w1); \
+            Ops::store(z2 + lane, w2); \
+        } \
+        for (; lane < lanes; ++lane) { \
+            T w1 = z1[lane]; \
+            T w2 = z2[lane]; \
+            T* x = data + lane; \
+            for (int t = 0; t < samples; ++t, x += lanes) { \
+                T input = *x; \
+                T y = c0*input + w1; \
+                w1 = c1*input + w2 - d1*y; \
+                w2 = c2*input - d2*y; \
+                *x = y; \
+            } \
+            z1[lane] = w1; \
+            z2[lane] = w2; \
+        } \
+    }
+
+template<class T>
+QDSP_SSE2 void biquadCascadeSse2(const QBiquad* sections, int sectionCount, T* state, T* data, int samples, int lanes)
+{ QDSP_BIQUAD_CASCADE(Sse2Ops<T>) }
+
+template<class T>
+QDSP_AVX2 void biquadCascadeAvx2(const QBiquad* sections, int sectionCount, T* state, T* data, int samples, int lanes)
+{ QDSP_BIQUAD_CASCADE(Avx2Ops<T>) }
+
+template<class T>
+QDSP_AVX512 void biquadCascadeAvx512(const QBiquad* sections, int sectionCount, T* state, T* data, int samples, int lanes)
+{ QDSP_BIQUAD_CASCADE(Avx512Ops<T>) }
+
+// Каждый элемент регистра - резонатор отдельной частоты, состояние
+// резонаторов хранится в регистрах на протяжении всего сигнала, а отсчёт
+// сигнала размножается по элементам регистра. Как и в каскаде звеньев,
+// рекурсию скрывают четыре независимых регистра.
+#define QDSP_GOERTZEL_STEP(Ops, c, u1, u2) { \
+        auto s0 = Ops::multiplyAdd(c, u1, Ops::sub(x, u2)); \
+        u2 = u1; \
+        u1 = s0; \
+    }
+
+#define QDSP_GOERTZEL_RESONATORS(Ops) \
+    constexpr int width = 2*Ops::width; \
+    int k = 0; \
+    for (; k + 4*width <= count; k += 4*width) { \
+        auto c0 = Ops::load(coefficients + k); \
+        auto c1 = Ops::load(coefficients + k + width); \
+        auto c2 = Ops::load(coefficients + k + 2*width); \
+        auto c3 = Ops::load(coefficients + k + 3*width); \
+        auto u1 = Ops::load(s1 + k); \
+        auto u2 = Ops::load(s2 + k); \
+        auto v1 = Ops::load(s1 + k + width); \
+        auto v2 = Ops::load(s2 + k + width); \
+        auto w1 = Ops::load(s1 + k + 2*width); \
+        auto w2 = Ops::load(s2 + k + 2*width); \
+        auto r1 = Ops::load(s1 + k + 3*width); \
+        auto r2 = Ops::load(s2 + k + 3*width); \
+        for (int n = 0; n < size; ++n) { \
+            auto x = Ops::broadcast(signal[n]); \
+            QDSP_GOERTZEL_STEP(Ops, c0, u1, u2) \
+            QDSP_GOERTZEL_STEP(Ops, c1, v1, v2) \
+            QDSP_GOERTZEL_STEP(Ops, c2, w1, w2) \
+            QDSP_GOERTZEL_STEP(Ops, c3, r1, r2) \
+        } \
+        Ops::store(s1 + k, u1); \
+        Ops::store(s2 + k, u2); \
+        Ops::store(s1 + k + width, v1); \
+        Ops::store(s2 + k + width, v2); \
+        Ops::store(s1 + k + 2*width, w1); \
+        Ops::store(s2 + k + 2*width, w2); \
+        Ops::store(s1 + k + 3*width, r1); \
+        Ops::store(s2 + k + 3*width, r2); \
+    } \
+    for (; k + width <= count; k += width) { \
+        auto c0 = Ops::load(coefficients + k); \
+        auto u1 = Ops::load(s1 + k); \
+        auto u2 = Ops::load(s2 + k); \
+        for (int n = 0; n < size; ++n) { \
+            auto x = Ops::broadcast(signal[n]); \
+            QDSP_GOERTZEL_STEP(Ops, c0, u1, u2) \
+        } \
+        Ops::store(s1 + k, u1); \
+        Ops::store(s2 + k, u2); \
+    } \
+    for (; k < count; ++k) { \
+        const T c = coefficients[k]; \
+        T u1 = s1[k]; \
+        T u2 = s2[k]; \
+        for (int n = 0; n < size; ++n) { \
+            T s0 = c*u1 + (signal[n] - u2); \
+            u2 = u1; \
+            u1 = s0; \
+        } \
+        s1[k] = u1; \
+        s2[k] = u2; \
+    }
+
+template<class T>
+QDSP_SSE2 void goertzelResonatorsSse2(const T* coefficients, T* s1, T* s2, int count, const T* signal, int size)
+{ QDSP_GOERTZEL_RESONATORS(Sse2Ops<T>) }
+
+template<class T>
+QDSP_AVX2 void goertzelResonatorsAvx2(const T* coefficients, T* s1, T* s2, int count, const T* signal, int size)
+{ QDSP_GOERTZEL_RESONATORS(Avx2Ops<T>) }
+
+template<class T>
+QDSP_AVX512 void goertzelResonatorsAvx512(const T* coefficients, T* s1, T* s2, int count, const T* signal, int size)
+{ QDSP_GOERTZEL_RESONATORS(Avx512Ops<T>) }
+
+#undef QDSP_GOERTZEL_RESONATORS
+#undef QDSP_GOERTZEL_STEP
+
+#undef QDSP_BIQUAD_CASCADE
+#undef QDSP_BIQUAD_STEP
+#undef QDSP_SSE2
+#undef QDSP_AVX2
+#undef QDSP_AVX512
+#endif
+
+template<class T>
+using Radix4Butterflies = void (*)(std::complex<T>*, int, const std::complex<T>*);
+
+template<class T>
+struct Radix4Kernel {
+    Radix4Butterflies<T> butterflies;
+    // Количество комплексных отсчётов в векторном регистре
+    int width;
+};
+
+template<class T>
+Radix4Kernel<T> radix4Kernel(SimdInstructionSet instructionSet)
+{
+    switch (instructionSet) {
+#ifdef QDSP_X86_SIMD
+    case SimdInstructionSet::SSE2: return {radix4ButterfliesSse2<T>, Sse2Ops<T>::width};
+    case SimdInstructionSet::AVX2: return {radix4ButterfliesAvx2<T>, Avx2Ops<T>::width};
+    case SimdInstructionSet::AVX512: return {radix4ButterfliesAvx512<T>, Avx512Ops<T>::width};
+#endif
+    default: return {[](std::complex<T>* x, int quarter, const std::complex<T>* w) { radix4Butterflies(x, quarter, w); }, 1};
+    }
+}
+
+template<class T>
+using DotProducts = void (*)(const T*, const T*, int, int, int, T*);
+
+template<class T>
+DotProducts<T> dotProductsKernel(SimdInstructionSet instructionSet)
+{
+    switch (instructionSet) {
+#ifdef QDSP_X86_SIMD
+    case SimdInstructionSet::SSE2: return dotProductsSse2<T>;
+    case SimdInstructionSet::AVX2: return dotProductsAvx2<T>;
+    case SimdInstructionSet::AVX512: return dotProductsAvx512<T>;
+#endif
+    default: return dotProducts<T>;
+    }
+}
+
+template<class T>
+using BiquadCascade = void (*)(const QBiquad*, int, T*, T*, int, int);
+
+template<class T>
+BiquadCascade<T> biquadCascadeKernel(SimdInstructionSet instructionSet)
+{
+    switch (instructionSet) {
+#ifdef QDSP_X86_SIMD
+    case SimdInstructionSet::SSE2: return biquadCascadeSse2<T>;
+    case SimdInstructionSet::AVX2: return biquadCascadeAvx2<T>;
+    case SimdInstructionSet::AVX512: return biquadCascadeAvx512<T>;
+#endif
+    default: return biquadCascade<T>;
+    }
+}
+
+template<class T>
+using GoertzelResonators = void (*)(const T*, T*, T*, int, const T*, int);
+
+template<class T>
+GoertzelResonators<T> goertzelResonatorsKernel(SimdInstructionSet instructionSet)
+{
+    switch (instructionSet) {
+#ifdef QDSP_X86_SIMD
+    case SimdInstructionSet::SSE2: return goertzelResonatorsSse2<T>;
+    case SimdInstructionSet::AVX2: return goertzelResonatorsAvx2<T>;
+    case SimdInstructionSet::AVX512: return goertzelResonatorsAvx512<T>;
+#endif
+    default: return goertzelResonators<T>;
+    }
+}
+
+bool cpuSupports(SimdInstructionSet instructionSet)
+{
+    switch (instructionSet) {
+    case SimdInstructionSet::Scalar: return true;
+#ifdef QDSP_X86_SIMD
+    case SimdInstructionSet::SSE2: return __builtin_cpu_supports("sse2");
+    case SimdInstructionSet::AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case SimdInstructionSet::AVX512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") &&
+                                            __builtin_cpu_supports("fma");
+#endif
+    default: return false;
+    }
+}
+
+std::atomic<SimdInstructionSet>& currentSimdInstructionSet()
+{
+    static std::atomic<SimdInstructionSet> instructionSet(supportedSimdInstructionSet());
+    return instructionSet;
+}
+
+} // namespace
+
+bool isSimdInstructionSetSupported(SimdInstructionSet instructionSet)
+{
+#ifdef QDSP_X86_SIMD
+    __builtin_cpu_init();
+#endif
+    return cpuSupports(instructionSet);
+}
+
+SimdInstructionSet supportedSimdInstructionSet()
+{
+    for (auto instructionSet: {SimdInstructionSet::AVX512, SimdInstructionSet::AVX2, SimdInstructionSet::SSE2}) {
+        if (isSimdInstructionSetSupported(instructionSet)) {
+            return instructionSet;
+        }
+    }
+    return SimdInstructionSet::Scalar;
+}
+
+SimdInstructionSet simdInstructionSet()
+{
+    return currentSimdInstructionSet();
+}
+
+void setSimdInstructionSet(SimdInstructionSet instructionSet)
+{
+    if (!isSimdInstructionSetSupported(instructionSet)) {
+        throw std::invalid_argument("SIMD instruction set is not supported");
+    }
+    currentSimdInstructionSet() = instructionSet;
+}
+
+void detail::dotProducts(const QReal* taps, const QReal* x, int n, int step, int count, QReal* sums)
+{
+    dotProductsKernel<QReal>(simdInstructionSet())(taps, x, n, step, count, sums);
+}
+
+void detail::biquadCascade(const QBiquad* sections, int sectionCount, QReal* state, QReal* data, int samples, int lanes)
+{
+    biquadCascadeKernel<QReal>(simdInstructionSet())(sections, sectionCount, state, data, samples, lanes);
+}
+
+void detail::goertzelResonators(const QReal* coefficients, QReal* s1, QReal* s2, int count,
+                                const QReal* signal, int size)
+{
+    goertzelResonatorsKernel<QReal>(simdInstructionSet())(coefficients, s1, s2, count, signal, size);
+}
+
+namespace {
+
+// Пул потоков пакетного и многопоточного БПФ. Рабочие потоки создаются при
+// первом использовании и ожидают заданий на условной переменной; задание -
+// набор независимых индексов, которые потоки разбирают через атомарный счётчик.
+class QFftThreadPool
+{
+public:
+    static QFftThreadPool& instance()
+    {
+        static QFftThreadPool pool;
+        return pool;
+    }
+
+    ~QFftThreadPool() { this->stop_(); }
+
+    int threadCount() const { return threadCount_; }
+
+    void setThreadCount(int count)
+    {
+        if (count < 1) {
+            throw std::invalid_argument("Thread count must be positive");
+        }
+        std::lock_guard<std::mutex> guard(runMutex_);
+        this->stop_();
+        threadCount_ = count;
+    }
+
+    void run(int count, const std::function<void(int)>& task)
+    {
+        if (insidePool_ || threadCount_ < 2 || count < 2 || !runMutex_.try_lock()) {
+            for (int i = 0; i < count; ++i) {
+                task(i);
+            }
+            return;
+        }
+        std::lock_guard<std::mutex> guard(runMutex_, std::adopt_lock);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // Новый поток должен принять задание, выставленное ниже
+            while ((int)workers_.size() < threadCount_ - 1) {
+                workers_.emplace_back([this, generation = generation_]() { this->work_(generation); });
+            }
+            task_ = &task;
+            count_ = count;
+            next_ = 0;
+            active_ = workers_.size();
+            error_ = nullptr;
+            ++generation_;
+        }
+        start_.notify_all();
+        this->execute_();
+        std::unique_lock<std::mutex> lock(mutex_);
+        finish_.wait(lock, [this]() { return active_ == 0; });
+        task_ = nullptr;
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+private:
+    QFftThreadPool()
+        : threadCount_(std::max(1u, std::thread::hardware_concurrency()))
+    {}
+
+    void execute_()
+    {
+        insidePool_ = true;
+        try {
+            for (int i = next_++; i < count_; i = next_++) {
+                (*task_)(i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = std::current_exception();
+            next_ = count_;
+        }
+        insidePool_ = false;
+    }
+
+    void work_(quint64 generation)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            start_.wait(lock, [&]() { return stopped_ || generation_ != generation; });
+            if (stopped_) {
+                return;
+            }
+            generation = generation_;
+            lock.unlock();
+            this->execute_();
+            lock.lock();
+            if (--active_ == 0) {
+                finish_.notify_one();
+            }
+        }
+    }
+
+    void stop_()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        start_.notify_all();
+        for (auto& worker: workers_) {
+            worker.join();
+        }
+        workers_.clear();
+        stopped_ = false;
+    }
+
+    static thread_local bool insidePool_;
+
+    std::mutex runMutex_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable finish_;
+    std::vector<std::thread> workers_;
+    std::atomic<int> threadCount_;
+    const std::function<void(int)>* task_ = nullptr;
+    int count_ = 0;
+    std::atomic<int> next_ {0};
+    int active_ = 0;
+    quint64 generation_ = 0;
+    bool stopped_ = false;
+    std::exception_ptr error_;
+};
+
+thread_local bool QFftThreadPool::insidePool_ = false;
+
+} // namespace
+
+int fftThreadCount()
+{
+    return QFftThreadPool::instance().threadCount();
+}
+
+void setFftThreadCount(int count)
+{
+    QFftThreadPool::instance().setThreadCount(count);
+}
+
+void detail::parallelFor(int count, const std::function<void(int)>& task)
+{
+    QFftThreadPool::instance().run(count, task);
+}
+
+template<class Complex>
+void detail::transpose(const Complex* source, Complex* destination, int rows, int columns)
+{
+    // Блок 16x16 комплексных отсчётов занимает 4 КБ и вместе с блоком
+    // назначения помещается в кэш первого уровня
+    static constexpr int tileSize = 16;
+    static constexpr qint64 minParallelSize = 1 << 16;
+    auto transposeBand = [&](int band) {
+        int rowEnd = std::min(rows, (band + 1)*tileSize);
+        for (int column = 0; column < columns; column += tileSize) {
+            int columnEnd = std::min(columns, column + tileSize);
+            for (int r = band*tileSize; r < rowEnd; ++r) {
+                const Complex* x = source + (qint64)r*columns;
+                for (int c = column; c < columnEnd; ++c) {
+                    destination[(qint64)c*rows + r] = x[c];
+                }
+            }
+        }
+    };
+    int bands = (rows + tileSize - 1) / tileSize;
+    if ((qint64)rows*columns < minParallelSize) {
+        for (int band = 0; band < bands; ++band) {
+            transposeBand(band);
+        }
+    } else {
+        detail::parallelFor(bands, transposeBand);
+    }
+}
+
+template void detail::transpose(const std::complex<float>*, std::complex<float>*, int, int);
+template void detail::transpose(const std::complex<double>*, std::complex<double>*, int, int);
+
+template<class T>
+QBasicFftPlan<T>::QBasicFftPlan(int size)
+    : size_(size)
+{
+    if (size < 0) {
+        throw std::invalid_argument("FFT size must be positive");
+    }
+    if (size == 0) {
+        return;
+    }
+    if (isPowerOfTwo(size) && log2(size) >= fourStepMinPower_) {
+        // Четырёхшаговый алгоритм Бейли: size = rows * columns, ДПФ сводится
+        // к ДПФ размерности rows по столбцам и размерности columns по строкам
+        // матрицы rows x columns, которые помещаются в кэш, с умножением на
+        // W_N^(n2*k1) между ними. Множители хранятся двумя таблицами:
+        // W_N^b для b < rows и W_N^(a*rows) для a < columns.
+        algorithm_ = Algorithm::FourStep;
+        power_ = log2(size);
+        int rows = 1 << (power_ / 2);
+        int columns = size / rows;
+        rowPlan_ = QBasicFftPlanCache<T>::plan(rows);
+        columnPlan_ = QBasicFftPlanCache<T>::plan(columns);
+        workspaceSize_ = size;
+        rotateMultiplers_.resize(rows + columns);
+        for (int b = 0; b < rows; ++b) {
+            rotateMultiplers_[b] = exponent<T>(-2*M_PI*b/size);
+        }
+        for (int a = 0; a < columns; ++a) {
+            rotateMultiplers_[rows + a] = exponent<T>(-2*M_PI*a/columns);
+        }
+        return;
+    }
+    if (isPowerOfTwo(size)) {
+        algorithm_ = Algorithm::Radix4;
+        power_ = log2(size);
+        // Поворачивающие множители хранятся отдельно для каждого каскада radix-4
+        // тремя последовательными таблицами W^k, W^2k, W^3k, где
+        // W = exp(-2*pi*i/m), m - размер блока каскада, что позволяет загружать
+        // множители соседних бабочек одним векторным чтением. Для нечётной
+        // степени последний каскад radix-2 в множителях не нуждается.
+        int tableSize = 0;
+        for (int power = power_; power >= 2; power -= 2) {
+            tableSize += 3 * (1 << (power - 2));
+        }
+        rotateMultiplers_.resize(tableSize);
+        Complex* w = rotateMultiplers_.data();
+        for (int power = power_; power >= 2; power -= 2) {
+            int blockSize = 1 << power;
+            for (int n = 1; n <= 3; ++n) {
+                for (int k = 0; k < blockSize/4; ++k) {
+                    *w++ = exponent<T>(-2*M_PI/blockSize*n*k);
+                }
+            }
+        }
+        reversal_ = detail::QBitReversal(power_);
+        return;
+    }
+
+    int rest = size;
+    for (int radix: {4, 2, 3, 5, 7}) {
+        while (rest % radix == 0) {
+            factors_.append(radix);
+            rest /= radix;
+        }
+    }
+    if (rest == 1) {
+        algorithm_ = Algorithm::MixedRadix;
+        workspaceSize_ = size;
+        // Для каждого каскада: W_n^(p*u), p < n/radix, 0 < u < radix
+        int n = size;
+        for (int radix: factors_) {
+            int m = n / radix;
+            for (int p = 0; p < m; ++p) {
+                for (int u = 1; u < radix; ++u) {
+                    rotateMultiplers_.append(exponent<T>(-2*M_PI*p*u/n));
+                }
+            }
+            n = m;
+        }
+        return;
+    }
+
+    // Размерность содержит простые множители больше 7: ДПФ сводится к свёртке
+    // с ЛЧМ-сигналом (алгоритм Блюстейна), которая вычисляется с помощью БПФ
+    // размерностью 2^k >= 2*size - 1
+    algorithm_ = Algorithm::Bluestein;
+    factors_.clear();
+    int convolutionSize = 1;
+    while (convolutionSize < 2*size - 1) {
+        convolutionSize <<= 1;
+    }
+    bluesteinPlan_ = QBasicFftPlanCache<T>::plan(convolutionSize);
+    // Два буфера свёртки и рабочий буфер плана свёртки
+    workspaceSize_ = 2*convolutionSize + bluesteinPlan_->workspaceSize();
+    chirp_.resize(size);
+    for (int n = 0; n < size; ++n) {
+        // n^2 mod 2N сохраняет точность фазы при больших n
+        int64_t n2 = (int64_t)n * n % (2 * (int64_t)size);
+        chirp_[n] = exponent<T>(-M_PI*n2/size);
+    }
+    QVector<Complex> filter(convolutionSize);
+    filter[0] = std::conj(chirp_[0]);
+    for (int n = 1; n < size; ++n) {
+        filter[n] = filter[convolutionSize - n] = std::conj(chirp_[n]);
+    }
+    chirpSpectrum_.resize(convolutionSize);
+    QVector<Complex> workspace(bluesteinPlan_->workspaceSize());
+    bluesteinPlan_->transform(filter.data(), chirpSpectrum_.data(), workspace.data());
+}
+
+template<class T>
+void QBasicFftPlan<T>::transform(Complex* data, Complex* output, Complex* workspace) const
+{
+    switch (algorithm_) {
+    case Algorithm::Radix4: this->transformRadix4_(data, output); break;
+    case Algorithm::MixedRadix: this->transformMixedRadix_(data, output, workspace); break;
+    case Algorithm::FourStep: this->transformFourStep_(data, output, workspace); break;
+    default: this->transformBluestein_(data, output, workspace);
+    }
+}
+
+template<class T>
+void QBasicFftPlan<T>::transformRadix4_(Complex* data, Complex* output) const
+{
+    // Прореживание по частоте, каскады radix-2^2: каждый каскад эквивалентен
+    // двум каскадам radix-2, поэтому результат остаётся в бит-реверсном
+    // порядке, но на 4 точки приходится 3 комплексных умножения вместо 4.
+    // Векторизованные бабочки используются в каскадах, где четверть блока
+    // не меньше числа отсчётов в векторном регистре
+    Radix4Kernel<T> kernel = radix4Kernel<T>(simdInstructionSet());
+    const Complex* w = rotateMultiplers_.constData();
+    int power = power_;
+    for (; power >= 2; power -= 2) {
+        int quarter = 1 << (power - 2);
+        if (quarter >= kernel.width) {
+            for (int j = 0; j < size_; j += 4*quarter) {
+                kernel.butterflies(data + j, quarter, w);
+            }
+        } else {
+            for (int j = 0; j < size_; j += 4*quarter) {
+                radix4Butterflies(data + j, quarter, w);
+            }
+        }
+        w += 3*quarter;
+    }
+    if (power == 1) {
+        for (int j = 0; j < size_; j += 2) {
+            Complex a = data[j];
+            data[j] = a + data[j+1];
+            data[j+1] = a - data[j+1];
+        }
+    }
+    if (power_ == 0) {
+        output[0] = data[0];
+    } else {
+        reversal_.copy(data, output);
+    }
+}
+
+template<class T>
+void QBasicFftPlan<T>::transformFourStep_(Complex* data, Complex* output, Complex* workspace) const
+{
+    // Вход - матрица rows x columns: x[n1*columns + n2]
+    static constexpr int bandWidth = 16;
+    int rows = rowPlan_->size();
+    int columns = columnPlan_->size();
+    const Complex* low = rotateMultiplers_.constData();
+    const Complex* high = low + rows;
+    // ДПФ по столбцам. Столбцы обрабатываются полосами по bandWidth: полоса
+    // копируется в свою часть workspace (строки по 256 байт), преобразуется
+    // в соответствующую часть output и после умножения на W_N^(n2*k1)
+    // возвращается на место
+    detail::parallelFor(columns / bandWidth, [&](int band) {
+        int first = band*bandWidth;
+        Complex* x = workspace + (qint64)first*rows;
+        Complex* y = output + (qint64)first*rows;
+        for (int n1 = 0; n1 < rows; ++n1) {
+            const Complex* source = data + (qint64)n1*columns + first;
+            for (int j = 0; j < bandWidth; ++j) {
+                x[j*rows + n1] = source[j];
+            }
+        }
+        for (int j = 0; j < bandWidth; ++j) {
+            rowPlan_->transform(x + j*rows, y + j*rows, nullptr);
+        }
+        for (int k1 = 0; k1 < rows; ++k1) {
+            Complex* destination = data + (qint64)k1*columns + first;
+            for (int j = 0; j < bandWidth; ++j) {
+                int m = (first + j)*k1;
+                destination[j] = multiply(y[j*rows + k1], multiply(high[m / rows], low[m % rows]));
+            }
+        }
+    });
+    // ДПФ по строкам, результат X[k1 + rows*k2] - после транспонирования
+    detail::parallelFor(rows, [&](int k1) {
+        columnPlan_->transform(data + (qint64)k1*columns, workspace + (qint64)k1*columns, nullptr);
+    });
+    detail::transpose(workspace, output, rows, columns);
+}
+
+template<class T>
+void QBasicFftPlan<T>::transformMixedRadix_(Complex* data, Complex* output, Complex* workspace) const
+{
+    if (factors_.isEmpty()) {
+        std::copy_n(data, size_, output);
+        return;
+    }
+    // Буферы чередуются так, чтобы последний каскад писал в output
+    int stages = factors_.size();
+    const Complex* x = data;
+    const Complex* w = rotateMultiplers_.constData();
+    int n = size_;
+    int s = 1;
+    for (int i = 0; i < stages; ++i) {
+        Complex* y = (stages - 1 - i) % 2 == 0 ? output : workspace;
+        int radix = factors_[i];
+        int m = n / radix;
+        switch (radix) {
+        case 2: mixedRadixStage<2>(x, y, m, s, w); break;
+        case 3: mixedRadixStage<3>(x, y, m, s, w); break;
+        case 4: mixedRadixStage<4>(x, y, m, s, w); break;
+        case 5: mixedRadixStage<5>(x, y, m, s, w); break;
+        default: mixedRadixStage<7>(x, y, m, s, w);
+        }
+        w += m*(radix - 1);
+        x = y;
+        n = m;
+        s *= radix;
+    }
+}
+
+template<class T>
+void QBasicFftPlan<T>::transformBluestein_(Complex* data, Complex* output, Complex* workspace) const
+{
+    int convolutionSize = bluesteinPlan_->size();
+    Complex* a = workspace;
+    Complex* spectrum = workspace + convolutionSize;
+    Complex* convolutionWorkspace = spectrum + convolutionSize;
+    for (int n = 0; n < size_; ++n) {
+        a[n] = multiply(data[n], chirp_[n]);
+    }
+    std::fill(a + size_, a + convolutionSize, Complex());
+    bluesteinPlan_->transform(a, spectrum, convolutionWorkspace);
+    // Обратное БПФ путём перемены местами re и im на входе и выходе
+    for (int k = 0; k < convolutionSize; ++k) {
+        Complex x = multiply(spectrum[k], chirpSpectrum_[k]);
+        spectrum[k] = Complex(x.imag(), x.real());
+    }
+    bluesteinPlan_->transform(spectrum, a, convolutionWorkspace);
+    T factor = T(1) / convolutionSize;
+    for (int k = 0; k < size_; ++k) {
+        output[k] = factor * multiply(Complex(a[k].imag(), a[k].real()), chirp_[k]);
+    }
+}
+
+template<class T>
+void QBasicFftWorkspace<T>::reserve(const QBasicFftPlan<T>& plan)
+{
+    if (input_.size() < plan.size()) {
+        input_.resize(plan.size());
+    }
+    // Дополнительный отсчёт нужен для половины спектра действительного сигнала
+    if (output_.size() < plan.size() + 1) {
+        output_.resize(plan.size() + 1);
+    }
+    if (scratch_.size() < plan.workspaceSize()) {
+        scratch_.resize(plan.workspaceSize());
+    }
+}
+
+template<class T>
+QBasicFftWorkspace<T>& QBasicFftWorkspace<T>::threadLocal()
+{
+    static thread_local QBasicFftWorkspace workspace;
+    return workspace;
+}
+
+namespace {
+
+template<class T>
+struct QFftPlanCacheStorage
+{
+    std::mutex mutex;
+    std::unordered_map<int, std::shared_ptr<const QBasicFftPlan<T>>> plans;
+    std::atomic<quint64> hits {0};
+    std::atomic<quint64> misses {0};
+};
+
+template<class T>
+QFftPlanCacheStorage<T>& fftPlanCacheStorage()
+{
+    static QFftPlanCacheStorage<T> storage;
+    return storage;
+}
+
+} // namespace
+
+template<class T>
+std::shared_ptr<const QBasicFftPlan<T>> QBasicFftPlanCache<T>::plan(int size)
+{
+    QFftPlanCacheStorage<T>& storage = fftPlanCacheStorage<T>();
+    {
+        std::lock_guard<std::mutex> lock(storage.mutex);
+        auto it = storage.plans.find(size);
+        if (it != storage.plans.end()) {
+            ++storage.hits;
+            return it->second;
+        }
+    }
+    // План создаётся без блокировки: построение может быть долгим и само
+    // обращаться к кэшу (план Блюстейна использует план степени двойки)
+    auto plan = std::make_shared<const QBasicFftPlan<T>>(size);
+    std::lock_guard<std::mutex> lock(storage.mutex);
+    ++storage.misses;
+    // Если план той же размерности уже создан другим потоком, используется он
+    return storage.plans.emplace(size, std::move(plan)).first->second;
+}
+
+template<class T>
+int QBasicFftPlanCache<T>::count()
+{
+    QFftPlanCacheStorage<T>& storage = fftPlanCacheStorage<T>();
+    std::lock_guard<std::mutex> lock(storage.mutex);
+    return storage.plans.size();
+}
+
+template<class T>
+quint64 QBasicFftPlanCache<T>::hits()
+{
+    return fftPlanCacheStorage<T>().hits;
+}
+
+template<class T>
+quint64 QBasicFftPlanCache<T>::misses()
+{
+    return fftPlanCacheStorage<T>().misses;
+}
+
+template<class T>
+void QBasicFftPlanCache<T>::clear()
+{
+    QFftPlanCacheStorage<T>& storage = fftPlanCacheStorage<T>();
+    std::lock_guard<std::mutex> lock(storage.mutex);
+    storage.plans.clear();
+}
+
+template<class T>
+void QBasicFftPlanCache<T>::resetStatistics()
+{
+    QFftPlanCacheStorage<T>& storage = fftPlanCacheStorage<T>();
+    storage.hits = 0;
+    storage.misses = 0;
+}
+
+template<class T>
+QBasicFft<T>::QBasicFft(int fftSize, bool inverted)
+    : inverted_(inverted)
+{
+    this->setSize(fftSize);
+}
+
+template<class T>
+QBasicFft<T>::QBasicFft(std::shared_ptr<const Plan> plan, bool inverted)
+    : inverted_(inverted)
+{
+    this->setPlan(std::move(plan));
+}
+
+template<class T>
+void QBasicFft<T>::setSize(int size)
+{
+    this->setPlan(QBasicFftPlanCache<T>::plan(size));
+}
+
+template<class T>
+void QBasicFft<T>::setPlan(std::shared_ptr<const Plan> plan)
+{
+    if (!plan) {
+        throw std::invalid_argument("FFT plan must not be null");
+    }
+    plan_ = std::move(plan);
+    fftSize_ = plan_->size();
+    fftPower_ = fftSize_ > 0 ? floor(log2(fftSize_)) : 0;
+}
+
+template<class T>
+void QBasicFft<T>::setPower(int power)
+{
+    if (power < 0) {
+        throw std::invalid_argument("FFT power must be positive");
+    }
+    this->setSize(power == 0 ? 0 : 0x1<<power);
+}
+
+template<class T>
+void QBasicFft<T>::process_(Complex* result, Workspace& workspace) const
+{
+    plan_->transform(workspace.input(), result, workspace.scratch());
+    if (inverted_) {
+        std::for_each(result, result + fftSize_,
+                      [](Complex& x) { x = Complex(x.imag(), x.real()); });
+    } else {
+        T factor = T(1) / fftSize_;
+        std::for_each(result, result + fftSize_,
+                      [factor](Complex& x) { x *= factor; });
+    }
+}
+
+template<class T>
+void QBasicFft<T>::processBatch_(int channelCount, const std::function<void(int)>& task) const
+{
+    // Для коротких пакетов затраты на синхронизацию потоков превышают выигрыш
+    static constexpr qint64 minParallelSamples = 1 << 14;
+    if ((qint64)channelCount * fftSize_ < minParallelSamples) {
+        for (int i = 0; i < channelCount; ++i) {
+            task(i);
+        }
+        return;
+    }
+    detail::parallelFor(channelCount, task);
+}
+
+template<class T>
+QBasicRealFft<T>::QBasicRealFft(int fftSize, bool fullSpectrum)
+    : fullSpectrum_(fullSpectrum)
+{
+    this->setSize(fftSize);
+}
+
+template<class T>
+void QBasicRealFft<T>::setSize(int size)
+{
+    if (size < 0) {
+        throw std::invalid_argument("FFT size must be positive");
+    }
+    fftSize_ = size;
+    fftPower_ = size > 0 ? floor(log2(size)) : 0;
+    // Сигнал нечётной размерности не упаковывается, для него вычисляется
+    // комплексное БПФ полной размерности
+    bool packed = size % 2 == 0;
+    plan_ = QBasicFftPlanCache<T>::plan(packed ? size/2 : size);
+
+    rotateMultiplers_.resize(packed ? size/2 : 0);
+    for (int i = 0; i < rotateMultiplers_.size(); i++) {
+        rotateMultiplers_[i] = exponent<T>(-2*M_PI/fftSize_*i);
+    }
+}
+
+template<class T>
+void QBasicRealFft<T>::setPower(int power)
+{
+    if (power < 0) {
+        throw std::invalid_argument("FFT power must be positive");
+    }
+    this->setSize(power == 0 ? 0 : 0x1<<power);
+}
+
+template<class T>
+void QBasicRealFft<T>::process_(Complex* result, Workspace& workspace) const
 {
-    this->updateRotateMultiplers_();
+    int resultSize = fullSpectrum_ ? fftSize_ : fftSize_/2 + 1;
+    Complex* spectrum = workspace.output();
+    plan_->transform(workspace.input(), spectrum, workspace.scratch());
+    if (fftSize_ % 2 != 0) {
+        T factor = T(1) / fftSize_;
+        std::transform(spectrum, spectrum + resultSize, result,
+                       [factor](Complex x) { return x * factor; });
+        return;
+    }
+    // Чётные отсчёты упакованы в действительную часть, нечётные - в мнимую.
+    // Спектры чётной и нечётной последовательностей разделяются по
+    // свойству симметрии спектра действительного сигнала:
+    // E[k] = (Z[k] + Z*[M-k]) / 2, O[k] = -i(Z[k] - Z*[M-k]) / 2,
+    // X[k] = E[k] + W^k * O[k], где M = N/2.
+    int halfSize = fftSize_/2;
+    spectrum[halfSize] = spectrum[0];
+    T factor = T(0.5) / fftSize_;
+    for (int k = 0; k < halfSize; ++k) {
+        Complex z = spectrum[k];
+        Complex zc = std::conj(spectrum[halfSize - k]);
+        result[k] = factor * ((z + zc) + multiply(rotateMultiplers_[k], rotate(z - zc)));
+    }
+    // W^M = -1
+    result[halfSize] = factor * ((spectrum[0] + std::conj(spectrum[0])) -
+                                 rotate(spectrum[0] - std::conj(spectrum[0])));
+    if (fullSpectrum_) {
+        for (int k = halfSize + 1; k < fftSize_; ++k) {
+            result[k] = std::conj(result[fftSize_ - k]);
+        }
+    }
 }
 
-void QFft::setPower(int power)
+template<class T>
+void QBasicRealFft<T>::processInverse_(T* result, Workspace& workspace) const
 {
-    fftPower_ = power;
-    this->updateRotateMultiplers_();
+    // Обратное БПФ путём перемены местами re и im на входе и выходе
+    Complex* buffer = workspace.input();
+    Complex* spectrum = workspace.output();
+    if (fftSize_ % 2 != 0) {
+        for (int k = fftSize_/2 + 1; k < fftSize_; ++k) {
+            spectrum[k] = std::conj(spectrum[fftSize_ - k]);
+        }
+        for (int k = 0; k < fftSize_; ++k) {
+            buffer[k] = Complex(spectrum[k].imag(), spectrum[k].real());
+        }
+        plan_->transform(buffer, spectrum, workspace.scratch());
+        for (int n = 0; n < fftSize_; ++n) {
+            result[n] = spectrum[n].imag();
+        }
+        return;
+    }
+    // Восстановление упакованного спектра Z[k] = E[k] + i*O[k] по половине
+    // спектра действительного сигнала и обратное БПФ размерности N/2
+    int halfSize = fftSize_/2;
+    for (int k = 0; k < halfSize; ++k) {
+        Complex x = spectrum[k];
+        Complex xc = std::conj(spectrum[halfSize - k]);
+        // Умножение на i: -rotate()
+        Complex z = (x + xc) - rotate(multiply(std::conj(rotateMultiplers_[k]), x - xc));
+        buffer[k] = Complex(z.imag(), z.real());
+    }
+    plan_->transform(buffer, spectrum, workspace.scratch());
+    for (int n = 0; n < halfSize; ++n) {
+        result[2*n] = spectrum[n].imag();
+        result[2*n+1] = spectrum[n].real();
+    }
 }
 
-int QFft::reverseBits_(int number, int bitCount)
+template class QBasicFftPlan<float>;
+template class QBasicFftPlan<double>;
+template class QBasicFftWorkspace<float>;
+template class QBasicFftWorkspace<double>;
+template class QBasicFftPlanCache<float>;
+template class QBasicFftPlanCache<double>;
+template class QBasicFft<float>;
+template class QBasicFft<double>;
+template class QBasicRealFft<float>;
+template class QBasicRealFft<double>;
+
+template<class Input, class Output>
+void detail::fastConvolution(const Input* x, int xSize, const QComplex* h, int hSize,
+                             qint64 first, int count, Output* result)
 {
-    int result = 0;
-    int saveBits = number;
-    for (int i = 1; i <= bitCount; ++i) {
-        result = result << 1;
-        int nextBit = saveBits & 1;
-        result = result | nextBit;
-        saveBits = saveBits >> 1;
+    // Блок длины blockSize даёт step = blockSize - hSize + 1 верных отсчётов
+    // линейной свёртки; блок в 4 раза длиннее ядра - компромисс между
+    // долей отбрасываемых отсчётов и длиной БПФ
+    static constexpr qint64 minParallelSize = 1 << 15;
+    // Для действительных сигнала и ядра два соседних блока обрабатываются одним
+    // комплексным БПФ: первый в действительной части, второй в мнимой
+    constexpr bool packed = std::is_same<Output, QReal>::value;
+    static_assert(!packed || std::is_same<Input, QReal>::value, "Real output requires real signal");
+    if (count <= 0 || hSize <= 0) {
+        return;
+    }
+    int blockSize = 64;
+    while (blockSize < 4*hSize) {
+        blockSize <<= 1;
+    }
+    int fullSize = 1;
+    while (fullSize < count + hSize - 1) {
+        fullSize <<= 1;
+    }
+    blockSize = std::min(blockSize, fullSize);
+    int step = blockSize - hSize + 1;
+    auto plan = QFftPlanCache::plan(blockSize);
+
+    QVector<QComplex> kernelSpectrum(blockSize);
+    {
+        QVector<QComplex> kernel(blockSize);
+        QVector<QComplex> workspace(plan->workspaceSize());
+        std::copy(h, h + hSize, kernel.begin());
+        plan->transform(kernel.data(), kernelSpectrum.data(), workspace.data());
+    }
+    // Обратное БПФ вычисляется прямым с перестановкой действительной и
+    // мнимой частей, нормировка входит в спектр ядра
+    QReal factor = QReal(1) / blockSize;
+    for (QComplex& value: kernelSpectrum) {
+        value *= factor;
+    }
+
+    int blocks = (count + step - 1) / step;
+    int tasks = packed ? (blocks + 1) / 2 : blocks;
+    const QComplex* spectrumH = kernelSpectrum.constData();
+    auto task = [&](int t) {
+        QFftWorkspace& workspace = QFftWorkspace::threadLocal();
+        workspace.reserve(*plan);
+        QComplex* buffer = workspace.input();
+        QComplex* spectrum = workspace.output();
+        int block = packed ? 2*t : t;
+        qint64 begin = first + (qint64)block*step;
+        // Отсчёты сигнала вне [0, xSize) считаются нулевыми
+        auto sample = [&](qint64 index) {
+            return (index >= 0 && index < xSize) ? x[index] : Input();
+        };
+        qint64 start = begin - (hSize - 1);
+        bool hasPair = packed && block + 1 < blocks;
+        for (int i = 0; i < blockSize; ++i) {
+            if constexpr (packed) {
+                buffer[i] = QComplex(sample(start + i), hasPair ? sample(start + step + i) : QReal());
+            } else {
+                buffer[i] = sample(start + i);
+            }
+        }
+        plan->transform(buffer, spectrum, workspace.scratch());
+        for (int k = 0; k < blockSize; ++k) {
+            QComplex y = spectrum[k]*spectrumH[k];
+            buffer[k] = QComplex(y.imag(), y.real());
+        }
+        plan->transform(buffer, spectrum, workspace.scratch());
+        // Отсчёты циклической свёртки начиная с hSize - 1 совпадают с линейной
+        const QComplex* valid = spectrum + (hSize - 1);
+        int size = (int)std::min<qint64>(step, first + count - begin);
+        Output* y = result + (begin - first);
+        for (int j = 0; j < size; ++j) {
+            if constexpr (packed) {
+                y[j] = valid[j].imag();
+            } else {
+                y[j] = QComplex(valid[j].imag(), valid[j].real());
+            }
+        }
+        if (hasPair) {
+            size = (int)std::min<qint64>(step, first + count - begin - step);
+            y += step;
+            for (int j = 0; j < size; ++j) {
+                y[j] = valid[j].real();
+            }
+        }
+    };
+    if (count < minParallelSize) {
+        for (int t = 0; t < tasks; ++t) {
+            task(t);
+        }
+    } else {
+        detail::parallelFor(tasks, task);
     }
-    return result;
 }
 
-void QFft::updateRotateMultiplers_()
+template void detail::fastConvolution(const QReal*, int, const QComplex*, int, qint64, int, QReal*);
+template void detail::fastConvolution(const QReal*, int, const QComplex*, int, qint64, int, QComplex*);
+template void detail::fastConvolution(const QComplex*, int, const QComplex*, int, qint64, int, QComplex*);
+
+void QGoertzel::setFrequencies(const QVector<QFrequency>& frequencies, QFrequency clock)
 {
-    if (fftPower_ < 0) {
-        throw std::invalid_argument("FFT power must be positive");
+    if (!frequencies.isEmpty() && !clock.isPositive()) {
+        throw std::invalid_argument(detail::msgNoClockError.toStdString());
+    }
+    frequencies_ = frequencies;
+    clock_ = clock;
+    int count = frequencies.size();
+    normFrequencies_.resize(count);
+    coefficients_.resize(count);
+    rotations_.resize(count);
+    for (int k = 0; k < count; ++k) {
+        normFrequencies_[k] = frequencies[k] / clock;
+        coefficients_[k] = 2*cos(2*M_PI*normFrequencies_[k]);
+        rotations_[k] = exponent<double>(-2*M_PI*normFrequencies_[k]);
+    }
+}
+
+void QGoertzel::process_(const QReal* signal, int size, QComplex* result) const
+{
+    // Состояние резонаторов s[n-1] и s[n-2] в буфере вызывающего потока:
+    // память выделяется только при увеличении количества частот
+    static thread_local QVector<QReal> state;
+    int count = frequencies_.size();
+    if (state.size() < 2*count) {
+        state.resize(2*count);
+    }
+    QReal* s1 = state.data();
+    QReal* s2 = s1 + count;
+    std::fill(s1, s1 + 2*count, QReal(0));
+    detail::goertzelResonators(coefficients_.constData(), s1, s2, count, signal, size);
+    // X(w) = sum(x[n]*exp(-i*w*n)) = exp(-i*w*(N-1)) * (s[N-1] - exp(-i*w)*s[N-2])
+    for (int k = 0; k < count; ++k) {
+        std::complex<double> y = s1[k] - rotations_[k]*s2[k];
+        // Фаза приводится к периоду до умножения на 2*pi, чтобы не терять
+        // точность на длинных сигналах
+        double turns = normFrequencies_[k]*(size > 0 ? size - 1 : 0);
+        y *= exponent<double>(-2*M_PI*(turns - floor(turns)));
+        result[k] = size > 0 ? QComplex(y / (double)size) : QComplex();
+    }
+}
+
+QZoomFft::QZoomFft(int size, QFrequency clock, QFrequency center, QFrequency span, int binCount)
+    : size_(size), binCount_(binCount), clock_(clock), center_(center), span_(span)
+{
+    if (size < 0 || binCount < 0) {
+        throw std::invalid_argument("Zoom FFT size and bin count must be positive");
     }
-    if (fftPower_ == 0) {
-        rotateMultiplers_.resize(0);
-        buffer_.resize(0);
+    if (!clock.isPositive()) {
+        throw std::invalid_argument(detail::msgNoClockError.toStdString());
+    }
+    if (binCount == 0) {
         return;
     }
-    fftSize_ = 0x1<<fftPower_;
-    buffer_.resize(fftSize_);
+    // X[k] = sum(x[n] * A^-n * W^(n*k)), A = exp(2*pi*i*start), W = exp(-2*pi*i*step).
+    // Подстановка n*k = (n^2 + k^2 - (k - n)^2)/2 сводит сумму к свёртке с
+    // ЛЧМ-сигналом W^(-m^2/2), которая вычисляется с помощью БПФ
+    double start = this->frequency(0) / clock;
+    double step = span / clock / binCount;
+    int convolutionSize = 1;
+    while (convolutionSize < size + binCount - 1) {
+        convolutionSize <<= 1;
+    }
+    plan_ = QFftPlanCache::plan(convolutionSize);
+    // exp(-2*pi*i*turns): фаза приводится к периоду до умножения на 2*pi,
+    // чтобы не терять точность при больших n^2
+    auto rotation = [](double turns) { return exponent<QReal>(-2*M_PI*(turns - floor(turns))); };
+    chirp_.resize(size);
+    for (int n = 0; n < size; ++n) {
+        chirp_[n] = rotation(start*n + 0.5*step*((qint64)n*n));
+    }
+    QVector<QComplex> filter(convolutionSize);
+    for (int m = 0; m < binCount; ++m) {
+        filter[m] = std::conj(rotation(0.5*step*((qint64)m*m)));
+    }
+    for (int m = 1; m < size; ++m) {
+        filter[convolutionSize - m] = std::conj(rotation(0.5*step*((qint64)m*m)));
+    }
+    filterSpectrum_.resize(convolutionSize);
+    QVector<QComplex> workspace(plan_->workspaceSize());
+    plan_->transform(filter.data(), filterSpectrum_.data(), workspace.data());
+    // Нормировка обратного БПФ свёртки и нормировка прямого QFft
+    double factor = size > 0 ? 1.0 / ((double)convolutionSize*size) : 0;
+    rotateMultiplers_.resize(binCount);
+    for (int k = 0; k < binCount; ++k) {
+        rotateMultiplers_[k] = QReal(factor) * rotation(0.5*step*((qint64)k*k));
+    }
+}
+
+void QZoomFft::process_(QComplex* result, QFftWorkspace& workspace) const
+{
+    int convolutionSize = plan_->size();
+    QComplex* buffer = workspace.input();
+    QComplex* spectrum = workspace.output();
+    plan_->transform(buffer, spectrum, workspace.scratch());
+    // Обратное БПФ путём перемены местами re и im на входе и выходе
+    for (int k = 0; k < convolutionSize; ++k) {
+        QComplex x = multiply(spectrum[k], filterSpectrum_[k]);
+        buffer[k] = QComplex(x.imag(), x.real());
+    }
+    plan_->transform(buffer, spectrum, workspace.scratch());
+    for (int k = 0; k < binCount_; ++k) {
+        result[k] = multiply(QComplex(spectrum[k].imag(), spectrum[k].real()), rotateMultiplers_[k]);
+    }
+}
+
+QStft::QStft(const QAbstractWindow& window, int fftSize, int hop)
+    : fftSize_(fftSize), hop_(hop)
+{
+    if (fftSize <= 0 || hop <= 0) {
+        throw std::invalid_argument("STFT size and hop must be positive");
+    }
+    window_ = window.makeWindow(fftSize);
+    plan_ = QFftPlanCache::plan(fftSize);
+    workspace_.reserve(*plan_);
+    pending_.reserve(2*fftSize);
+}
+
+int QStft::frameCount(int samples) const
+{
+    qint64 available = pending_.size() + std::max(0, samples - skip_);
+    return available < fftSize_ ? 0 : (available - fftSize_) / hop_ + 1;
+}
+
+void QStft::reset()
+{
+    skip_ = 0;
+    // resize() в отличие от clear() сохраняет выделенную память
+    pending_.resize(0);
+}
+
+void QStft::process_(int count, QComplex* frames, QReal* magnitudes)
+{
+    QReal factor = QReal(1) / fftSize_;
+    for (int f = 0; f < count; ++f) {
+        const QComplex* x = pending_.constData() + (qint64)f*hop_;
+        QComplex* buffer = workspace_.input();
+        for (int i = 0; i < fftSize_; ++i) {
+            buffer[i] = x[i] * window_[i];
+        }
+        QComplex* spectrum = frames ? frames + (qint64)f*fftSize_ : workspace_.output();
+        plan_->transform(buffer, spectrum, workspace_.scratch());
+        if (frames) {
+            for (int i = 0; i < fftSize_; ++i) {
+                spectrum[i] *= factor;
+            }
+        } else {
+            QReal* magnitude = magnitudes + (qint64)f*fftSize_;
+            for (int i = 0; i < fftSize_; ++i) {
+                magnitude[i] = std::abs(spectrum[i]) * factor;
+            }
+        }
+    }
+    // Удаляются отсчёты, не входящие в следующие кадры. При шаге больше
+    // кадра часть отсчётов ещё не поступила, они пропускаются позже
+    qint64 consumed = (qint64)count*hop_;
+    if (consumed > pending_.size()) {
+        skip_ += consumed - pending_.size();
+        consumed = pending_.size();
+    }
+    pending_.remove(0, consumed);
+}
+
+QIstft::QIstft(const QAbstractWindow& window, int fftSize, int hop)
+    : fftSize_(fftSize), hop_(hop)
+{
+    if (fftSize <= 0 || hop <= 0) {
+        throw std::invalid_argument("STFT size and hop must be positive");
+    }
+    window_ = window.makeWindow(fftSize);
+    plan_ = QFftPlanCache::plan(fftSize);
+    workspace_.reserve(*plan_);
+    this->reset();
+}
+
+void QIstft::reset()
+{
+    int size = std::max(fftSize_, hop_);
+    accumulator_.fill(QComplex(), size);
+    normalization_.fill(0, size);
+}
+
+namespace {
+
+// Выдаёт count отсчётов суммы с перекрытием и сдвигает буферы суммирования
+void takeOverlapAdd(QComplex* accumulator, QReal* normalization, int size, QComplex* result, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        result[i] = normalization[i] > std::numeric_limits<QReal>::epsilon()
+                ? accumulator[i] / normalization[i] : QComplex();
+    }
+    std::copy(accumulator + count, accumulator + size, accumulator);
+    std::fill(accumulator + size - count, accumulator + size, QComplex());
+    std::copy(normalization + count, normalization + size, normalization);
+    std::fill(normalization + size - count, normalization + size, 0);
+}
+
+} // namespace
+
+int QIstft::compute(const QComplexSignal& frames, QComplexSignal& result)
+{
+    if (frames.size() % fftSize_ != 0) {
+        throw std::invalid_argument("Frame buffer size must be a multiple of FFT size");
+    }
+    int count = frames.size() / fftSize_;
+    result.resize(count*hop_);
+    result.setClock(frames.clock());
+    QComplex* accumulator = accumulator_.data();
+    QReal* normalization = normalization_.data();
+    for (int f = 0; f < count; ++f) {
+        const QComplex* spectrum = frames.constData() + (qint64)f*fftSize_;
+        QComplex* buffer = workspace_.input();
+        QComplex* output = workspace_.output();
+        // Обратное БПФ путём перемены местами re и im на входе и выходе
+        for (int i = 0; i < fftSize_; ++i) {
+            buffer[i] = QComplex(spectrum[i].imag(), spectrum[i].real());
+        }
+        plan_->transform(buffer, output, workspace_.scratch());
+        for (int i = 0; i < fftSize_; ++i) {
+            QReal w = window_[i];
+            accumulator[i] += w * QComplex(output[i].imag(), output[i].real());
+            normalization[i] += w*w;
+        }
+        takeOverlapAdd(accumulator, normalization, accumulator_.size(), result.data() + (qint64)f*hop_, hop_);
+    }
+    return result.size();
+}
+
+int QIstft::flush(QComplexSignal& result)
+{
+    int count = accumulator_.size() - hop_;
+    result.resize(count);
+    takeOverlapAdd(accumulator_.data(), normalization_.data(), accumulator_.size(), result.data(), count);
+    this->reset();
+    return count;
+}
+
+namespace {
+
+int welchHop(int fftSize, int overlap)
+{
+    if (overlap < 0 || overlap >= fftSize) {
+        throw std::invalid_argument("Overlap must be positive and less than FFT size");
+    }
+    return fftSize - overlap;
+}
+
+} // namespace
+
+QWelchPsd::QWelchPsd(const QAbstractWindow& window, int fftSize, int overlap, Averaging averaging)
+    : stft_(window, fftSize, welchHop(fftSize, overlap)), averaging_(averaging)
+{
+    QRealSignal w = window.makeWindow(fftSize);
+    for (QReal x: w) {
+        windowSum_ += x;
+        windowPowerSum_ += x*x;
+    }
+    this->reset();
+}
+
+void QWelchPsd::reset()
+{
+    stft_.reset();
+    accumulator_.fill(0, stft_.fftSize());
+    frameCount_ = 0;
+}
+
+void QWelchPsd::accumulate_(int count)
+{
+    int size = stft_.fftSize();
+    double* accumulator = accumulator_.data();
+    for (int f = 0; f < count; ++f) {
+        const QReal* magnitude = magnitudes_.constData() + (qint64)f*size;
+        switch (averaging_) {
+        case Averaging::Linear:
+            for (int k = 0; k < size; ++k) {
+                accumulator[k] += magnitude[k];
+            }
+            break;
+        case Averaging::Rms:
+            for (int k = 0; k < size; ++k) {
+                accumulator[k] += (double)magnitude[k]*magnitude[k];
+            }
+            break;
+        case Averaging::MaxHold:
+            for (int k = 0; k < size; ++k) {
+                accumulator[k] = std::max(accumulator[k], (double)magnitude[k]*magnitude[k]);
+            }
+            break;
+        }
+    }
+    frameCount_ += count;
+}
+
+QRealSignal QWelchPsd::powerSpectrum(bool oneSided) const
+{
+    // Модули спектров кадров нормированы на N, мощность тона нормируется
+    // на квадрат когерентного усиления окна sum(w)
+    int size = stft_.fftSize();
+    double factor = (double)size*size / (windowSum_*windowSum_);
+    QRealSignal spectrum(size);
+    spectrum.setClock(clock_);
+    for (int k = 0; k < size; ++k) {
+        double value = 0;
+        if (frameCount_ > 0) {
+            switch (averaging_) {
+            case Averaging::Linear: value = pow(accumulator_[k] / frameCount_, 2); break;
+            case Averaging::Rms: value = accumulator_[k] / frameCount_; break;
+            case Averaging::MaxHold: value = accumulator_[k]; break;
+            }
+        }
+        spectrum[k] = factor*value;
+    }
+    if (!oneSided) {
+        return spectrum;
+    }
+    // Мощность отрицательных частот переносится на положительные
+    QRealSignal result(size/2 + 1);
+    result.setClock(clock_);
+    result[0] = spectrum[0];
+    for (int k = 1; k <= size/2; ++k) {
+        result[k] = spectrum[k] + (k == size - k ? 0 : spectrum[size - k]);
+    }
+    return result;
+}
+
+QRealSignal QWelchPsd::psd(bool oneSided) const
+{
+    if (!clock_.isPositive()) {
+        throw std::invalid_argument(detail::msgNoClockError.toStdString());
+    }
+    QRealSignal result = this->powerSpectrum(oneSided);
+    result /= (QReal)(this->enbw() * clock_.value() / stft_.fftSize());
+    return result;
+}
+
+double QWelchPsd::enbw() const
+{
+    return stft_.fftSize() * windowPowerSum_ / (windowSum_*windowSum_);
+}
+
+QFft2d::QFft2d(int rows, int columns, bool inverted)
+    : rows_(rows), columns_(columns), inverted_(inverted)
+{
+    if (rows <= 0 || columns <= 0) {
+        throw std::invalid_argument("2D FFT rows and columns must be positive");
+    }
+    rowPlan_ = QFftPlanCache::plan(columns);
+    columnPlan_ = QFftPlanCache::plan(rows);
+}
+
+void QFft2d::Workspace::reserve(const QFft2d& fft)
+{
+    int size = fft.rows()*fft.columns();
+    if (buffer_.size() < size) {
+        buffer_.resize(size);
+    }
+    if (transposed_.size() < size) {
+        transposed_.resize(size);
+    }
+}
+
+QFft2d::Workspace& QFft2d::Workspace::threadLocal()
+{
+    static thread_local Workspace workspace;
+    return workspace;
+}
+
+void QFft2d::setRowWindow(const QAbstractWindow& window)
+{
+    rowWindow_ = window.makeWindow(columns_);
+}
+
+void QFft2d::setColumnWindow(const QAbstractWindow& window)
+{
+    columnWindow_ = window.makeWindow(rows_);
+}
+
+void QFft2d::resetWindows()
+{
+    rowWindow_ = QRealSignal();
+    columnWindow_ = QRealSignal();
+}
+
+template<class Input>
+void QFft2d::process_(const Input* matrix, Workspace& workspace) const
+{
+    // Для небольших матриц затраты на синхронизацию потоков превышают выигрыш
+    static constexpr qint64 minParallelSamples = 1 << 14;
+    auto run = [&](int count, const std::function<void(int)>& task) {
+        if ((qint64)rows_*columns_ < minParallelSamples) {
+            for (int i = 0; i < count; ++i) {
+                task(i);
+            }
+        } else {
+            detail::parallelFor(count, task);
+        }
+    };
+    // Буферы вызывающего потока заполняются потоками пула по непересекающимся
+    // строкам и столбцам
+    QComplex* buffer = workspace.buffer_.data();
+    QComplex* transposed = workspace.transposed_.data();
+    // Расчёт обратного БПФ ведём путём перемены местами re и im на входе и выходе.
+    // Нормировка прямого преобразования выполняется вместе с окном столбцов
+    auto load = [this](QComplex x, QReal weight) {
+        return inverted_ ? QComplex(x.imag(), x.real())*weight : x*weight;
+    };
+    QReal factor = inverted_ ? QReal(1) : QReal(1) / (rows_*columns_);
+
+    // БПФ строк
+    run(rows_, [&](int row) {
+        QFftWorkspace& fftWorkspace = QFftWorkspace::threadLocal();
+        fftWorkspace.reserve(*rowPlan_);
+        QComplex* x = fftWorkspace.input();
+        const Input* source = matrix + (qint64)row*columns_;
+        for (int i = 0; i < columns_; ++i) {
+            x[i] = load(source[i], rowWindow_.isEmpty() ? QReal(1) : rowWindow_[i]);
+        }
+        rowPlan_->transform(x, buffer + (qint64)row*columns_, fftWorkspace.scratch());
+    });
+    detail::transpose(buffer, transposed, rows_, columns_);
+
+    // БПФ столбцов, которые после транспонирования расположены подряд
+    run(columns_, [&](int column) {
+        QFftWorkspace& fftWorkspace = QFftWorkspace::threadLocal();
+        fftWorkspace.reserve(*columnPlan_);
+        QComplex* x = fftWorkspace.input();
+        const QComplex* source = transposed + (qint64)column*rows_;
+        for (int i = 0; i < rows_; ++i) {
+            x[i] = source[i]*(columnWindow_.isEmpty() ? factor : factor*columnWindow_[i]);
+        }
+        QComplex* y = buffer + (qint64)column*rows_;
+        columnPlan_->transform(x, y, fftWorkspace.scratch());
+        if (inverted_) {
+            std::for_each(y, y + rows_, [](QComplex& z) { z = QComplex(z.imag(), z.real()); });
+        }
+    });
+}
+
+template void QFft2d::process_(const QReal* matrix, Workspace& workspace) const;
+template void QFft2d::process_(const QComplex* matrix, Workspace& workspace) const;
+
+std::pair<int, int> detail::rationalApproximation(double ratio, int maxFactor)
+{
+    // Подходящие дроби h/k: h[i] = a[i]*h[i-1] + h[i-2], k[i] = a[i]*k[i-1] + k[i-2]
+    qint64 h0 = 0;
+    qint64 h1 = 1;
+    qint64 k0 = 1;
+    qint64 k1 = 0;
+    double x = ratio;
+    while (true) {
+        double a = floor(x);
+        qint64 h2 = a*h1 + h0;
+        qint64 k2 = a*k1 + k0;
+        if (h2 > maxFactor || k2 > maxFactor) {
+            break;
+        }
+        h0 = h1;
+        h1 = h2;
+        k0 = k1;
+        k1 = k2;
+        if (fabs((double)h1/k1 - ratio) <= 1e-12*ratio || x == a) {
+            break;
+        }
+        x = 1 / (x - a);
+    }
+    if (h1 == 0 || k1 == 0) {
+        throw std::invalid_argument("Resampling ratio is out of range");
+    }
+    return {(int)h1, (int)k1};
+}
+
+QRealSignal detail::resamplerFilter(int interpolation, int decimation, int halfLength)
+{
+    // Формулы Кайзера для подавления attenuation дБ: параметр окна и ширина
+    // переходной полосы в долях меньшей из частот дискретизации
+    constexpr double attenuation = 80;
+    double beta = 0.1102*(attenuation - 8.7);
+    double transition = (attenuation - 7.95) / (14.36*2*halfLength);
+    int factor = std::max(interpolation, decimation);
+    double cutoff = (0.5 - transition/2) / factor;
+    int size = 2*halfLength*factor + 1;
+    QRealSignal result = QKaiserWindow::generate(size, beta / M_PI);
+    double center = (size - 1) / 2.0;
+    double sum = 0;
+    for (int i = 0; i < size; ++i) {
+        double t = i - center;
+        result[i] *= t == 0 ? 2*cutoff : sin(2*M_PI*cutoff*t) / (M_PI*t);
+        sum += result[i];
+    }
+    // Коэффициент передачи interpolation компенсирует нули, вставляемые при интерполяции
+    result *= interpolation / sum;
+    return result;
+}
+
+QCicState::QCicState(Type type, int order, int factor, int delay, int inputBits)
+    : type_(type), order_(order), factor_(factor), delay_(delay), inputBits_(inputBits)
+{
+    if (order <= 0 || factor <= 0 || delay <= 0) {
+        throw std::invalid_argument("CIC order, factor and delay must be positive");
+    }
+    if (inputBits < 2) {
+        throw std::invalid_argument("CIC input must have at least 2 bits");
+    }
+    gain_ = pow(double(factor)*delay, order) / (type == Type::Interpolator ? factor : 1);
+    // Рост разрядности по Хогенауэру; допуск защищает от погрешности log2 для
+    // точных степеней двойки
+    double growth = order*log2(double(factor)*delay) - (type == Type::Interpolator ? log2(factor) : 0);
+    int width = inputBits + int(ceil(growth - 1e-9));
+    if (width > 64) {
+        throw std::invalid_argument("CIC register width exceeds 64 bits");
+    }
+    registerWidth_ = width;
+    integrators_.resize(order);
+    combs_.resize(order*delay);
+    reset();
+}
+
+int QCicState::process(const qint64* input, int size, qint64* output)
+{
+    // Беззнаковая арифметика даёт переполнение по модулю 2^64 без
+    // неопределённого поведения
+    int count = 0;
+    if (type_ == Type::Decimator) {
+        for (int i = 0; i < size; ++i) {
+            quint64 x = quint64(input[i]);
+            for (quint64& integrator: integrators_) {
+                integrator += x;
+                x = integrator;
+            }
+            if (phase_ == 0) {
+                output[count++] = this->signExtend_(this->comb_(x));
+            }
+            if (++phase_ == factor_) {
+                phase_ = 0;
+            }
+        }
+    } else {
+        for (int i = 0; i < size; ++i) {
+            quint64 x = this->comb_(quint64(input[i]));
+            // Между отсчётами входа вставляются factor-1 нулей
+            for (int r = 0; r < factor_; ++r) {
+                for (quint64& integrator: integrators_) {
+                    integrator += x;
+                    x = integrator;
+                }
+                output[count++] = this->signExtend_(x);
+                x = 0;
+            }
+        }
+    }
+    return count;
+}
+
+int QCicState::outputCount(int samples) const
+{
+    if (type_ == Type::Interpolator) {
+        return samples*factor_;
+    }
+    int first = (factor_ - phase_) % factor_;
+    return samples > first ? (samples - first - 1) / factor_ + 1 : 0;
+}
+
+void QCicState::reset()
+{
+    integrators_.fill(0);
+    combs_.fill(0);
+    combPosition_ = 0;
+    phase_ = 0;
+}
+
+quint64 QCicState::comb_(quint64 x)
+{
+    for (int n = 0; n < order_; ++n) {
+        quint64& delayed = combs_[n*delay_ + combPosition_];
+        quint64 previous = delayed;
+        delayed = x;
+        x -= previous;
+    }
+    if (++combPosition_ == delay_) {
+        combPosition_ = 0;
+    }
+    return x;
+}
+
+qint64 QCicState::signExtend_(quint64 x) const
+{
+    int shift = 64 - registerWidth_;
+    return qint64(x << shift) >> shift;
+}
+
+QRealSignal cicCompensationFilter(int order, int factor, int delay, int size, double passband)
+{
+    if (order <= 0 || factor <= 0 || delay <= 0 || size <= 0) {
+        throw std::invalid_argument("CIC compensation filter parameters must be positive");
+    }
+    if (passband <= 0 || passband >= 0.5) {
+        throw std::invalid_argument("CIC compensation passband must be in (0, 0.5)");
+    }
+    // Частотная выборка: желаемая АЧХ 1/|H(f)| в полосе пропускания и 0 вне её,
+    // где H(f) = (sin(pi*D*f) / (R*D*sin(pi*f/R)))^N на низкой частоте
+    // дискретизации. Импульсная характеристика - обратное преобразование Фурье
+    // этой АЧХ, ограниченное окном Кайзера.
+    constexpr int gridSize = 4096;
+    double step = passband / gridSize;
+    QVector<double> frequencies(gridSize);
+    QVector<double> response(gridSize);
+    for (int k = 0; k < gridSize; ++k) {
+        double f = (k + 0.5)*step;
+        double cic = sin(M_PI*delay*f) / (double(factor)*delay*sin(M_PI*f/factor));
+        frequencies[k] = f;
+        response[k] = pow(std::abs(cic), -order);
+    }
+    QRealSignal result = QKaiserWindow::generate(size, 2.0);
+    double center = (size - 1) / 2.0;
+    double sum = 0;
+    for (int i = 0; i < size; ++i) {
+        double t = i - center;
+        double h = 0;
+        for (int k = 0; k < gridSize; ++k) {
+            h += response[k]*cos(2*M_PI*frequencies[k]*t);
+        }
+        result[i] *= 2*h*step;
+        sum += result[i];
+    }
+    result *= 1 / sum;
+    return result;
+}
+
+namespace {
+
+enum class IirBand {LowPass, HighPass, BandPass};
+
+// Полюса одного звена; у звена первого порядка второго полюса нет
+struct IirSectionPoles {
+    std::complex<double> first;
+    std::complex<double> second;
+    bool firstOrder;
+};
+
+// Полюса аналогового фильтра-прототипа нижних частот с частотой среза
+// 1 рад/с и его коэффициент передачи. ripple = 0 соответствует фильтру
+// Баттерворта, иначе - фильтру Чебышёва I рода с пульсациями ripple дБ.
+QVector<std::complex<double>> analogPrototype(int order, double ripple, double& gain)
+{
+    QVector<std::complex<double>> poles(order);
+    double epsilon = sqrt(pow(10, ripple/10) - 1);
+    double mu = ripple > 0 ? asinh(1/epsilon) / order : 0;
+    std::complex<double> product = 1;
+    for (int k = 0; k < order; ++k) {
+        double theta = M_PI*(2*k + 1) / (2*order);
+        poles[k] = ripple > 0 ? std::complex<double>(-sinh(mu)*sin(theta), cosh(mu)*cos(theta))
+                              : std::complex<double>(-sin(theta), cos(theta));
+        product *= -poles[k];
+    }
+    gain = product.real();
+    // Фильтр Чебышёва чётного порядка имеет минимум пульсаций на нулевой частоте
+    if (ripple > 0 && order % 2 == 0) {
+        gain /= sqrt(1 + epsilon*epsilon);
+    }
+    return poles;
+}
+
+QVector<QBiquad> designIir(IirBand band, int order, double ripple, QFrequency low, QFrequency high, QFrequency clock)
+{
+    if (order <= 0 || ripple < 0 || !clock.isPositive()) {
+        throw std::invalid_argument("IIR filter order and clock must be positive");
+    }
+    double lowRatio = low / clock;
+    double highRatio = high / clock;
+    if (lowRatio <= 0 || lowRatio >= 0.5 || highRatio <= 0 || highRatio >= 0.5 ||
+            (band == IirBand::BandPass && lowRatio >= highRatio)) {
+        throw std::invalid_argument("IIR filter frequencies must be between 0 and the Nyquist frequency");
+    }
+    double gain;
+    QVector<std::complex<double>> prototype = analogPrototype(order, ripple, gain);
+
+    // Преобразование частот с предыскажением для билинейного преобразования
+    // s = 2*(z - 1)/(z + 1). Нули аналогового фильтра лежат в нуле (z = 1)
+    // и в бесконечности (z = -1).
+    auto warp = [](double ratio) { return 2*tan(M_PI*ratio); };
+    QVector<std::complex<double>> poles;
+    int zerosAtOrigin = 0;
+    switch (band) {
+    case IirBand::LowPass: {
+        double w = warp(lowRatio);
+        for (const auto& p: prototype) {
+            poles.append(w*p);
+        }
+        gain *= pow(w, order);
+        break;
+    }
+    case IirBand::HighPass: {
+        double w = warp(lowRatio);
+        std::complex<double> product = 1;
+        for (const auto& p: prototype) {
+            poles.append(w/p);
+            product *= -p;
+        }
+        gain /= product.real();
+        zerosAtOrigin = order;
+        break;
+    }
+    case IirBand::BandPass: {
+        double w1 = warp(lowRatio);
+        double w2 = warp(highRatio);
+        double bandwidth = w2 - w1;
+        double center = w1*w2;
+        for (const auto& p: prototype) {
+            std::complex<double> a = p*bandwidth/2.0;
+            std::complex<double> d = sqrt(a*a - center);
+            poles.append(a + d);
+            poles.append(a - d);
+        }
+        gain *= pow(bandwidth, order);
+        zerosAtOrigin = order;
+        break;
+    }
+    }
+    std::complex<double> product = pow(2.0, zerosAtOrigin);
+    for (auto& p: poles) {
+        product /= 2.0 - p;
+        p = (2.0 + p) / (2.0 - p);
+    }
+    gain *= product.real();
+
+    // Звенья из пар комплексно-сопряжённых полюсов и пар действительных
+    // полюсов; звенья с полюсами ближе к единичной окружности идут последними
+    QVector<IirSectionPoles> sections;
+    QVector<double> realPoles;
+    for (const auto& p: poles) {
+        if (std::abs(p.imag()) <= 1e-12*std::abs(p)) {
+            realPoles.append(p.real());
+        } else if (p.imag() > 0) {
+            sections.append({p, std::conj(p), false});
+        }
+    }
+    std::sort(realPoles.begin(), realPoles.end());
+    for (int i = 0; i < realPoles.size(); i += 2) {
+        bool firstOrder = i + 1 == realPoles.size();
+        sections.append({realPoles[i], firstOrder ? 0 : realPoles[i + 1], firstOrder});
+    }
+    std::sort(sections.begin(), sections.end(), [](const IirSectionPoles& a, const IirSectionPoles& b) {
+        return std::max(std::abs(a.first), std::abs(a.second)) < std::max(std::abs(b.first), std::abs(b.second));
+    });
+
+    int zerosAtNyquist = poles.size() - zerosAtOrigin;
+    QVector<QBiquad> result;
+    for (const IirSectionPoles& group: sections) {
+        // Полосовому фильтру по одному нулю каждого вида на звено
+        auto takeZero = [&](bool preferOrigin) {
+            if ((preferOrigin && zerosAtOrigin > 0) || zerosAtNyquist == 0) {
+                --zerosAtOrigin;
+                return 1.0;
+            }
+            --zerosAtNyquist;
+            return -1.0;
+        };
+        QBiquad section;
+        if (group.firstOrder) {
+            double z = takeZero(false);
+            section = {1, -z, 0, -group.first.real(), 0};
+        } else {
+            double z1 = takeZero(true);
+            double z2 = takeZero(false);
+            section = {1, -(z1 + z2), z1*z2, -(group.first + group.second).real(), (group.first*group.second).real()};
+        }
+        result.append(section);
+    }
+    result[0].b0 *= gain;
+    result[0].b1 *= gain;
+    result[0].b2 *= gain;
+    return result;
+}
+
+} // namespace
+
+QVector<QBiquad> butterworthLowPass(int order, QFrequency cutoff, QFrequency clock)
+{
+    return designIir(IirBand::LowPass, order, 0, cutoff, cutoff, clock);
+}
+
+QVector<QBiquad> butterworthHighPass(int order, QFrequency cutoff, QFrequency clock)
+{
+    return designIir(IirBand::HighPass, order, 0, cutoff, cutoff, clock);
+}
+
+QVector<QBiquad> butterworthBandPass(int order, QFrequency low, QFrequency high, QFrequency clock)
+{
+    return designIir(IirBand::BandPass, order, 0, low, high, clock);
+}
 
-    // Классический расчёт
-    rotateMultiplers_.resize(fftSize_/2);
-    for (int i = 0; i < fftSize_/2; i++) {
-        rotateMultiplers_[i] = QComplex(cos(2*M_PI/fftSize_*i),
-                                            -sin(2*M_PI/fftSize_*i));
+QVector<QBiquad> chebyshevLowPass(int order, double ripple, QFrequency cutoff, QFrequency clock)
+{
+    if (ripple <= 0) {
+        throw std::invalid_argument("Chebyshev filter ripple must be positive");
+    }
+    return designIir(IirBand::LowPass, order, ripple, cutoff, cutoff, clock);
+}
+
+QVector<QBiquad> chebyshevHighPass(int order, double ripple, QFrequency cutoff, QFrequency clock)
+{
+    if (ripple <= 0) {
+        throw std::invalid_argument("Chebyshev filter ripple must be positive");
     }
-    // Расчёт через комплексную экспоненту
-    // rotateMultiplers_ = QComplexSignal::harmonic(fftSize_/2, -1.0/fftSize_, 1);
+    return designIir(IirBand::HighPass, order, ripple, cutoff, cutoff, clock);
 }
 
-QComplexSignal QFft::process_(QFrequency resultBandwidth) const
+QVector<QBiquad> chebyshevBandPass(int order, double ripple, QFrequency low, QFrequency high, QFrequency clock)
 {
-    for (int i = fftPower_; i > 0; --i) {
-      int pow2i = 1 << i;
-      for (int j = 0; j < fftSize_/pow2i; ++j) {
-          for (int k = 0; k < pow2i/2; ++k) {
-              QComplex a = buffer_[pow2i*j+k] + buffer_[pow2i*j+k+pow2i/2];
-              QComplex b = rotateMultiplers_[k*1<<(fftPower_-i)] *
-                      (buffer_[pow2i*j+k] - buffer_[pow2i*j+k+pow2i/2]);
-              buffer_[pow2i*j+k] = a;
-              buffer_[pow2i*j+k+pow2i/2] = b;
-          }
-      }
+    if (ripple <= 0) {
+        throw std::invalid_argument("Chebyshev filter ripple must be positive");
     }
-    QComplexSignal result_(fftSize_, resultBandwidth);
-    for (int i = 0; i < fftSize_; ++i) {
-        QComplex x =  buffer_[this->reverseBits_(i, fftPower_)];
-        result_[i] = inverted_ ? QComplex(x.imag(), x.real()) : x/(double)fftSize_;
+    return designIir(IirBand::BandPass, order, ripple, low, high, clock);
+}
+
+QComplex frequencyResponse(const QVector<QBiquad>& sections, QFrequency frequency, QFrequency clock)
+{
+    std::complex<double> z = std::polar(1.0, -2*M_PI*(frequency / clock));
+    std::complex<double> result = 1;
+    for (const QBiquad& q: sections) {
+        result *= (q.b0 + z*(q.b1 + z*q.b2)) / (1.0 + z*(q.a1 + z*q.a2));
     }
-    return result_;
+    return QComplex(result);
 }
 
 const QString QBartlettHannWindow::windowName = "Bartlett-Hann";
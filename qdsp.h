@@ -14,7 +14,11 @@
 //#define QDSP_FLOAT_DISCRETE
 
 #include <complex>
+#include <functional>
+#include <memory>
 #include <numeric>
+#include <optional>
+#include <tuple>
 
 #include <QtMath>
 #include <QDateTime>
@@ -1581,6 +1585,24 @@ inline auto basicConvolution(InputIt1 first1, InputIt1 last1, ReverseIntputIt2 f
     }
 }
 
+// Начиная с этой длины более короткого сигнала свёртка вычисляется с помощью БПФ
+constexpr int fastConvolutionMinSize = 32;
+
+// Отсчёты [first, first + count) линейной свёртки сигнала x с ядром h,
+// вычисляемые методом перекрытия с накоплением (overlap-save) с помощью БПФ.
+// Реализовано для пар Input/Output: QReal/QReal (ядро действительное),
+// QReal/QComplex и QComplex/QComplex.
+template<class Input, class Output>
+void fastConvolution(const Input* x, int xSize, const QComplex* h, int hSize,
+                     qint64 first, int count, Output* result);
+
+// Скалярные произведения taps[0..n) и x[j*step..j*step + n), j = 0..count-1,
+// векторизованные для набора команд simdInstructionSet(). Суммы произведений
+// с чётными и нечётными индексами записываются в sums[2*j] и sums[2*j + 1]:
+// для комплексных отсчётов, уложенных парами (re, im), это действительная и
+// мнимая части.
+void dotProducts(const QReal* taps, const QReal* x, int n, int step, int count, QReal* sums);
+
 } // namespace detail
 
 template <class T1, class T2, class = std::enable_if_t<hasSignalResult<T1, T2>>>
@@ -1592,6 +1614,56 @@ auto correlation(const T1& signal1, const T2& signal2)
 
 }
 
+namespace detail {
+
+// Отсчёты [first, first + count) полной взаимной корреляции
+// c[m] = sum(signal1[k] * signal2[k + signal2.size() - 1 - m]), m = 0..signal1.size() + signal2.size() - 2.
+// Как и в basicCorrelation, отсчёты второго сигнала сопрягаются, если первый сигнал комплексный
+template<class T1, class T2, class Output>
+void correlationRange(const T1& signal1, const T2& signal2, int first, int count, Output* result)
+{
+    int size1 = signal1.size();
+    int size2 = signal2.size();
+    if (std::min(size1, size2) < fastConvolutionMinSize) {
+        for (int i = 0; i < count; ++i) {
+            int m = first + i;
+            int begin = std::max(0, m - size2 + 1);
+            int end = std::min(size1 - 1, m) + 1;
+            result[i] = basicCorrelation(signal1.begin() + begin,
+                                         signal1.begin() + end,
+                                         signal2.begin() + (begin + size2 - 1 - m));
+        }
+        return;
+    }
+
+    // Корреляция - свёртка signal1 с обращённым во времени signal2. Если короче
+    // первый сигнал, вычисляется обращённая во времени свёртка signal2 с
+    // обращённым signal1, чтобы ядром всегда был короткий сигнал, а длинный не копировался
+    constexpr bool conjugate = std::is_same<std::decay_t<decltype (*signal1.begin())>, QComplex>::value;
+    auto reversed = [](const auto& signal) {
+        QVector<QComplex> h(signal.size());
+        std::transform(signal.begin(), signal.end(), h.rbegin(),
+                       [](QComplex x) { return conjugate ? std::conj(x) : x; });
+        return h;
+    };
+    if (size2 <= size1) {
+        QVector<QComplex> h = reversed(signal2);
+        fastConvolution(signal1.data(), size1, h.constData(), size2, first, count, result);
+    } else {
+        QVector<QComplex> h = reversed(signal1);
+        fastConvolution(signal2.data(), size2, h.constData(), size1,
+                        (qint64)size1 + size2 - 1 - first - count, count, result);
+        std::reverse(result, result + count);
+        if constexpr (conjugate) {
+            for (int i = 0; i < count; ++i) {
+                result[i] = std::conj(result[i]);
+            }
+        }
+    }
+}
+
+} // namespace detail
+
 template<class T1, class T2, class = std::enable_if_t<isSignalContainer<T1> && isSignalContainer<T2>>>
 auto crossCorrelation(const T1& signal1, const T2& signal2, bool keepBeginTransientProcess = true, bool keepEndTransientProcess = false)
 {
@@ -1602,36 +1674,70 @@ auto crossCorrelation(const T1& signal1, const T2& signal2, bool keepBeginTransi
                                         (keepEndTransientProcess ? minSize - 1 : 0),
                                         detail::getResultClock(signal1.clock(), signal2.clock(), Q_FUNC_INFO));
 
-    // Переходный процесс
-    if (keepBeginTransientProcess) {
-        for (int i = 0; i < minSize - 1; ++i) {
-            result[i] = detail::basicCorrelation(signal1.begin(),
-                                                  signal1.begin() + (i + 1),
-                                                  signal2.end() - (i + 1));
-        }
-    }
+    // Отсчёт i результата - отсчёт i + minSize - 1 полной корреляции, если
+    // начальный переходный процесс отбрасывается. Если длина более короткого
+    // сигнала не меньше detail::fastConvolutionMinSize, корреляция вычисляется через БПФ
+    detail::correlationRange(signal1, signal2, keepBeginTransientProcess ? 0 : minSize - 1,
+                             result.size(), result.data());
+    return result;
+}
 
-    // Пересечение сигналов
-    int start = (keepBeginTransientProcess ? minSize - 1 : 0);
-    bool signal1Shorter = signal1.size() < signal2.size();
-    for (int i = 0; i < maxSize - minSize + 1; ++i) {
-        result[start + i] =
-                detail::basicCorrelation(signal1.begin() + (signal1Shorter ? 0 : i),
-                                          signal1.begin() + minSize + (signal1Shorter ? 0 : i),
-                                          signal2.end() - minSize - (signal1Shorter ? i : 0));
-    }
+// Пик взаимной корреляции: индекс отсчёта в результате crossCorrelation и его значение
+template<class T>
+struct QCorrelationPeak
+{
+    int index;
+    T value;
+};
 
-    // Переходный процесс
-    if (keepEndTransientProcess) {
-        start = maxSize;
-        for (int i = 0; i < minSize - 1; ++i) {
-            result[start + i] =
-                    detail::basicCorrelation(signal1.end() - minSize + i + 1,
-                                              signal1.end(),
-                                              signal2.begin());
+// count наибольших по модулю локальных максимумов модуля взаимной корреляции в
+// порядке убывания. Корреляция вычисляется частями и целиком не хранится
+template<class T1, class T2, class = std::enable_if_t<isSignalContainer<T1> && isSignalContainer<T2>>>
+auto crossCorrelationPeaks(const T1& signal1, const T2& signal2, int count, bool keepBeginTransientProcess = true, bool keepEndTransientProcess = false)
+{
+    using Value = typename detail::SignalResult<T1, T2>::value_type;
+    using Peak = QCorrelationPeak<Value>;
+    if (count < 0) {
+        throw std::invalid_argument("Peak count must be positive");
+    }
+    detail::getResultClock(signal1.clock(), signal2.clock(), Q_FUNC_INFO);
+    int minSize = std::min(signal1.size(), signal2.size());
+    int maxSize = std::max(signal1.size(), signal2.size());
+    int size = (keepBeginTransientProcess ? minSize - 1 : 0) +
+            maxSize - minSize + 1 +
+            (keepEndTransientProcess ? minSize - 1 : 0);
+    int offset = keepBeginTransientProcess ? 0 : minSize - 1;
+
+    // Куча из count пиков с наименьшим модулем в вершине
+    QVector<Peak> peaks;
+    auto greater = [](const Peak& lhs, const Peak& rhs) { return std::abs(lhs.value) > std::abs(rhs.value); };
+    // Части перекрываются на один отсчёт с каждой стороны для сравнения с соседями
+    int chunkSize = std::max(1 << 16, 16*minSize);
+    QVector<Value> chunk(chunkSize + 2);
+    for (int begin = 0; begin < size && count > 0; begin += chunkSize) {
+        int end = std::min(size, begin + chunkSize);
+        int from = std::max(0, begin - 1);
+        int to = std::min(size, end + 1);
+        detail::correlationRange(signal1, signal2, offset + from, to - from, chunk.data());
+        auto value = [&](int i) { return chunk[i - from]; };
+        for (int i = begin; i < end; ++i) {
+            double magnitude = std::abs(value(i));
+            if ((i > 0 && std::abs(value(i - 1)) >= magnitude) ||
+                    (i + 1 < size && std::abs(value(i + 1)) > magnitude)) {
+                continue;
+            }
+            if (peaks.size() < count) {
+                peaks.append(Peak{i, value(i)});
+                std::push_heap(peaks.begin(), peaks.end(), greater);
+            } else if (magnitude > std::abs(peaks.front().value)) {
+                std::pop_heap(peaks.begin(), peaks.end(), greater);
+                peaks.back() = Peak{i, value(i)};
+                std::push_heap(peaks.begin(), peaks.end(), greater);
+            }
         }
     }
-    return result;
+    std::sort_heap(peaks.begin(), peaks.end(), greater);
+    return peaks;
 }
 
 template<class T, class = std::enable_if_t<isSignalContainer<T>>>
@@ -1650,6 +1756,24 @@ auto convolution(const T1& signal1, const T2& signal2, bool keepBeginTransientPr
                                         (keepEndTransientProcess ? minSize - 1 : 0),
                                         detail::getResultClock(signal1.clock(), signal2.clock(), Q_FUNC_INFO));
 
+    // Длинные ядра: свёртка более короткого сигнала с более длинным через БПФ.
+    // Отсчёт i результата - отсчёт i + minSize - 1 полной свёртки, если
+    // начальный переходный процесс отбрасывается
+    if (minSize >= detail::fastConvolutionMinSize) {
+        auto fastConvolution = [&](const auto& kernel, const auto& signal) {
+            QVector<QComplex> h(kernel.size());
+            std::copy(kernel.begin(), kernel.end(), h.begin());
+            detail::fastConvolution(signal.data(), signal.size(), h.constData(), h.size(),
+                                    keepBeginTransientProcess ? 0 : minSize - 1, result.size(), result.data());
+        };
+        if (signal1.size() < signal2.size()) {
+            fastConvolution(signal1, signal2);
+        } else {
+            fastConvolution(signal2, signal1);
+        }
+        return result;
+    }
+
     // Переходный процесс
     if (keepBeginTransientProcess) {
         for (int i = 0; i < minSize - 1; ++i) {
@@ -1688,13 +1812,724 @@ auto firFilter(const T1& coefficients, const T2& signal, bool keepBeginTransient
     return convolution(coefficients, signal, keepBeginTransientProcess, keepEndTransientProcess);
 }
 
+namespace detail {
+
+// Коэффициенты и линия задержки потоковых КИХ фильтров. Коэффициенты
+// хранятся в обратном порядке: выход для отсчёта x[n] - скалярное произведение
+// с отсчётами x[n - size + 1..n]. Для комплексного сигнала, уложенного парами
+// (re, im), коэффициенты дублируются.
+template<class T, class S>
+class QFirState {
+public:
+    using Sample = typename S::value_type;
+    using Result = SignalResult<T, S>;
+    using Output = typename Result::value_type;
+
+    explicit QFirState(const T& coefficients)
+        : coefficients_(coefficients)
+    {
+        int size = coefficients.size();
+        if (size == 0) {
+            throw std::invalid_argument("FIR filter must have at least one coefficient");
+        }
+        real_.resize(pairSize_*size);
+        imag_.resize(isComplexSignalContainer<T> ? pairSize_*size : 0);
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < pairSize_; ++j) {
+                real_[pairSize_*(size - 1 - i) + j] = std::real(coefficients[i]);
+                if constexpr (isComplexSignalContainer<T>) {
+                    imag_[pairSize_*(size - 1 - i) + j] = std::imag(coefficients[i]);
+                }
+            }
+        }
+        this->reset();
+    }
+    // Добавляет фрагмент к линии задержки
+    template<class C>
+    void append(const C& chunk)
+    {
+        static_assert(std::is_same<typename C::value_type, Sample>::value,
+                      "Chunk must have the same sample type as the filter");
+        int history = coefficients_.size() - 1;
+        delayLine_.resize(history + chunk.size());
+        std::copy(chunk.begin(), chunk.end(), delayLine_.begin() + history);
+    }
+    // count выходов для отсчётов first, first + step, ... добавленного фрагмента
+    void compute(int first, int step, int count, Output* result)
+    {
+        const QReal* x = reinterpret_cast<const QReal*>(delayLine_.constData()) + pairSize_*first;
+        int size = real_.size();
+        sums_.resize(4*count);
+        QReal* a = sums_.data();
+        QReal* b = a + 2*count;
+        dotProducts(real_.constData(), x, size, pairSize_*step, count, a);
+        if constexpr (isComplexSignalContainer<T>) {
+            dotProducts(imag_.constData(), x, size, pairSize_*step, count, b);
+        }
+        for (int j = 0; j < count; ++j) {
+            if constexpr (isComplexSignalContainer<T> && isComplexSignalContainer<S>) {
+                // (hr + i*hi)*(xr + i*xi): a - произведения с hr, b - с hi
+                result[j] = QComplex(a[2*j] - b[2*j + 1], a[2*j + 1] + b[2*j]);
+            } else if constexpr (isComplexSignalContainer<T>) {
+                result[j] = QComplex(a[2*j] + a[2*j + 1], b[2*j] + b[2*j + 1]);
+            } else if constexpr (isComplexSignalContainer<S>) {
+                result[j] = QComplex(a[2*j], a[2*j + 1]);
+            } else {
+                result[j] = a[2*j] + a[2*j + 1];
+            }
+        }
+    }
+    // Оставляет в линии задержки последние size() - 1 отсчётов; resize() в
+    // отличие от clear() сохраняет выделенную память
+    void shift()
+    {
+        int history = coefficients_.size() - 1;
+        std::copy(delayLine_.end() - history, delayLine_.end(), delayLine_.begin());
+        delayLine_.resize(history);
+    }
+    void reset()
+    {
+        delayLine_.resize(0);
+        delayLine_.resize(coefficients_.size() - 1);
+    }
+    const T& coefficients() const { return coefficients_; }
+    int size() const { return coefficients_.size(); }
+
+private:
+    static constexpr int pairSize_ = isComplexSignalContainer<S> ? 2 : 1;
+    T coefficients_;
+    QVector<QReal> real_;
+    QVector<QReal> imag_;
+    QVector<Sample> delayLine_;
+    QVector<QReal> sums_;
+};
+
+} // namespace detail
+
+// Потоковый КИХ фильтр с коэффициентами типа T для сигнала типа S
+// (QRealSignal или QComplexSignal). Линия задержки сохраняется между вызовами
+// process, поэтому обработка сигнала по частям даёт тот же результат, что и
+// firFilter(coefficients, signal) для всего сигнала. Скалярные произведения
+// вычисляются векторизованными ядрами (см. SimdInstructionSet).
+template<class T, class S = T, class = std::enable_if_t<isSignalContainer<T> && isSignalContainer<S>>>
+class QFirFilter {
+public:
+    using Result = detail::SignalResult<T, S>;
+
+    explicit QFirFilter(const T& coefficients)
+        : state_(coefficients)
+    {}
+    template<class C, class = std::enable_if_t<isSignalContainer<C>>>
+    Result process(const C& chunk)
+    {
+        Result result;
+        this->process(chunk, result);
+        return result;
+    }
+    // Размер результата приводится к размеру chunk, память не выделяется,
+    // если result уже достаточного размера. chunk и result могут совпадать
+    template<class C, class = std::enable_if_t<isSignalContainer<C>>>
+    void process(const C& chunk, Result& result)
+    {
+        int size = chunk.size();
+        QFrequency clock = chunk.clock();
+        state_.append(chunk);
+        result.resize(size);
+        result.setClock(clock);
+        state_.compute(0, 1, size, result.data());
+        state_.shift();
+    }
+    // Фильтрация на месте
+    template<class U = S, class = std::enable_if_t<std::is_same<U, Result>::value>>
+    void transform(S& signal)
+    { this->process(signal, signal); }
+    // Обнуляет линию задержки
+    void reset() { state_.reset(); }
+    const T& coefficients() const { return state_.coefficients(); }
+    int size() const { return state_.size(); }
+private:
+    detail::QFirState<T, S> state_;
+};
+
+// Потоковый КИХ фильтр с децимацией: вычисляются только сохраняемые выходы
+// фильтра (каждый factor-й), поэтому затраты в factor раз меньше, чем у
+// фильтрации с последующей decimate. Для сигнала, размер которого кратен
+// factor, результат совпадает с decimate(firFilter(coefficients, signal), factor).
+template<class T, class S = T, class = std::enable_if_t<isSignalContainer<T> && isSignalContainer<S>>>
+class QFirDecimator {
+public:
+    using Result = detail::SignalResult<T, S>;
+
+    QFirDecimator(const T& coefficients, int factor)
+        : state_(coefficients), factor_(factor)
+    {
+        if (factor <= 0) {
+            throw std::invalid_argument("Decimation factor must be positive");
+        }
+    }
+    template<class C, class = std::enable_if_t<isSignalContainer<C>>>
+    Result process(const C& chunk)
+    {
+        Result result;
+        this->process(chunk, result);
+        return result;
+    }
+    // Выход формируется на каждом factor-м отсчёте, начиная с первого, поэтому
+    // размер результата может отличаться на единицу для фрагментов одного размера
+    template<class C, class = std::enable_if_t<isSignalContainer<C>>>
+    void process(const C& chunk, Result& result)
+    {
+        int size = chunk.size();
+        int count = this->outputCount(size);
+        QFrequency clock = chunk.clock() / factor_;
+        state_.append(chunk);
+        result.resize(count);
+        result.setClock(clock);
+        state_.compute(next_, factor_, count, result.data());
+        state_.shift();
+        next_ += count*factor_ - size;
+    }
+    // Количество выходов, которое будет получено после поступления samples отсчётов
+    int outputCount(int samples) const
+    { return samples > next_ ? (samples - next_ - 1) / factor_ + 1 : 0; }
+    // Обнуляет линию задержки, следующий выход формируется на первом отсчёте
+    void reset()
+    {
+        state_.reset();
+        next_ = 0;
+    }
+    int factor() const { return factor_; }
+    const T& coefficients() const { return state_.coefficients(); }
+    int size() const { return state_.size(); }
+private:
+    detail::QFirState<T, S> state_;
+    int factor_;
+    // Номер отсчёта следующего фрагмента, для которого формируется выход
+    int next_ = 0;
+};
+
+namespace detail {
+
+// Несократимая дробь numerator/denominator, ближайшая к ratio, с числителем
+// и знаменателем не больше maxFactor (цепные дроби)
+std::pair<int, int> rationalApproximation(double ratio, int maxFactor);
+
+// Прототип фильтра передискретизатора L/M для частоты дискретизации в L раз
+// выше входной: окно Кайзера (подавление около 80 дБ) и sinc с частотой среза
+// чуть ниже половины меньшей из входной и выходной частот дискретизации.
+// Фильтр занимает 2*halfLength отсчётов на меньшей из частот, коэффициент
+// передачи на нулевой частоте равен interpolation.
+QRealSignal resamplerFilter(int interpolation, int decimation, int halfLength);
+
+} // namespace detail
+
+// Потоковый передискретизатор с рациональным коэффициентом L/M, где L/M -
+// отношение выходной частоты дискретизации к входной. Используется
+// многофазная структура: каждый выход - скалярное произведение L-й фазы
+// фильтра-прототипа с входными отсчётами, поэтому нули, вставляемые при
+// интерполяции, и отбрасываемые при децимации отсчёты не вычисляются.
+// Линия задержки и положение следующего выхода сохраняются между вызовами
+// process. Выход задержан на delay() выходных отсчётов.
+template<class S, class = std::enable_if_t<isSignalBased<S>>>
+class QResampler {
+public:
+    using Sample = typename S::value_type;
+    // Наибольшие L и M; если отношение частот не выражается такой дробью,
+    // используется ближайшая, а частота outputClock() немного отличается от заданной
+    static constexpr int maxFactor = 4096;
+
+    QResampler(QFrequency inputClock, QFrequency outputClock, int halfLength = 32)
+        : inputClock_(inputClock)
+    {
+        if (!inputClock.isPositive() || !outputClock.isPositive()) {
+            throw std::invalid_argument("Resampler clocks must be positive");
+        }
+        if (halfLength <= 4) {
+            throw std::invalid_argument("Resampler filter half length must be greater than 4");
+        }
+        std::tie(interpolation_, decimation_) = detail::rationalApproximation(outputClock / inputClock, maxFactor);
+        coefficients_ = detail::resamplerFilter(interpolation_, decimation_, halfLength);
+        // Фазы фильтра в обратном порядке: фаза p - коэффициенты p, p + L, ...
+        phaseSize_ = (coefficients_.size() + interpolation_ - 1) / interpolation_;
+        phases_.resize(pairSize_*phaseSize_*interpolation_);
+        for (int p = 0; p < interpolation_; ++p) {
+            QReal* phase = phases_.data() + pairSize_*phaseSize_*p;
+            for (int k = 0; k < phaseSize_; ++k) {
+                int index = p + k*interpolation_;
+                for (int j = 0; j < pairSize_; ++j) {
+                    phase[pairSize_*(phaseSize_ - 1 - k) + j] = index < coefficients_.size() ? coefficients_[index] : 0;
+                }
+            }
+        }
+        this->reset();
+    }
+    template<class C, class = std::enable_if_t<isSignalContainer<C>>>
+    S process(const C& chunk)
+    {
+        S result;
+        this->process(chunk, result);
+        return result;
+    }
+    template<class C, class = std::enable_if_t<isSignalContainer<C>>>
+    void process(const C& chunk, S& result)
+    {
+        static_assert(std::is_same<typename C::value_type, Sample>::value,
+                      "Chunk must have the same sample type as the resampler");
+        if (chunk.hasClock() && chunk.clock() != inputClock_) {
+            throw std::invalid_argument("Chunk clock differs from resampler input clock");
+        }
+        int size = chunk.size();
+        int count = this->outputCount(size);
+        int history = phaseSize_ - 1;
+        delayLine_.resize(history + size);
+        std::copy(chunk.begin(), chunk.end(), delayLine_.begin() + history);
+        result.resize(count);
+        result.setClock(this->outputClock());
+
+        // Выход j соответствует отсчёту time_ + j*M на частоте в L раз выше
+        // входной. Выходы j и j + L используют одну фазу фильтра, а их входные
+        // отсчёты отстоят на M, поэтому для каждой фазы выполняется одно
+        // пакетное скалярное произведение. Выходы обрабатываются блоками по
+        // cycles*L, чтобы входные отсчёты блока оставались в кэше при переборе фаз
+        const QReal* x = reinterpret_cast<const QReal*>(delayLine_.constData());
+        int cycles = std::max(1, blockSamples_ / decimation_);
+        int blockSize = cycles*interpolation_;
+        sums_.resize(2*cycles);
+        for (int begin = 0; begin < count; begin += blockSize) {
+            int blockCount = std::min(blockSize, count - begin);
+            for (int g = begin; g < begin + std::min(blockCount, interpolation_); ++g) {
+                qint64 time = time_ + (qint64)g*decimation_;
+                int phase = time % interpolation_;
+                int sample = time / interpolation_;
+                int phaseCount = (begin + blockCount - g + interpolation_ - 1) / interpolation_;
+                detail::dotProducts(phases_.constData() + pairSize_*phaseSize_*phase,
+                                    x + pairSize_*sample, pairSize_*phaseSize_,
+                                    pairSize_*decimation_, phaseCount, sums_.data());
+                for (int j = 0; j < phaseCount; ++j) {
+                    if constexpr (isComplexSignalContainer<S>) {
+                        result[g + j*interpolation_] = QComplex(sums_[2*j], sums_[2*j + 1]);
+                    } else {
+                        result[g + j*interpolation_] = sums_[2*j] + sums_[2*j + 1];
+                    }
+                }
+            }
+        }
+        time_ += (qint64)count*decimation_ - (qint64)size*interpolation_;
+
+        // resize() в отличие от clear() сохраняет выделенную память
+        std::copy(delayLine_.end() - history, delayLine_.end(), delayLine_.begin());
+        delayLine_.resize(history);
+    }
+    // Количество выходов, которое будет получено после поступления samples отсчётов
+    int outputCount(int samples) const
+    {
+        qint64 available = (qint64)samples*interpolation_ - time_;
+        return available > 0 ? (available - 1) / decimation_ + 1 : 0;
+    }
+    // Обнуляет линию задержки, следующий выход соответствует первому отсчёту
+    void reset()
+    {
+        delayLine_.resize(0);
+        delayLine_.resize(phaseSize_ - 1);
+        time_ = 0;
+    }
+    int interpolation() const { return interpolation_; }
+    int decimation() const { return decimation_; }
+    QFrequency inputClock() const { return inputClock_; }
+    // Фактическая выходная частота дискретизации: inputClock()*L/M
+    QFrequency outputClock() const { return inputClock_ * interpolation_ / decimation_; }
+    // Групповая задержка фильтра в выходных отсчётах
+    double delay() const { return (coefficients_.size() - 1) / 2.0 / decimation_; }
+    // Прототип фильтра на частоте inputClock()*L
+    const QRealSignal& coefficients() const { return coefficients_; }
+
+private:
+    static constexpr int pairSize_ = isComplexSignalContainer<S> ? 2 : 1;
+    // Входных отсчётов на блок выходов
+    static constexpr int blockSamples_ = 2048;
+    QFrequency inputClock_;
+    int interpolation_ = 1;
+    int decimation_ = 1;
+    QRealSignal coefficients_;
+    int phaseSize_ = 0;
+    QVector<QReal> phases_;
+    QVector<Sample> delayLine_;
+    QVector<QReal> sums_;
+    // Положение следующего выхода относительно начала следующего фрагмента
+    // на частоте в L раз выше входной
+    qint64 time_ = 0;
+};
+
+// Передискретизация сигнала на частоту clock, см. QResampler
+template<class T, class = std::enable_if_t<isSignalBased<T>>>
+T resample(const T& signal, QFrequency clock)
+{
+    if (!signal.hasClock()) {
+        throw std::invalid_argument(detail::msgNoClockError.toStdString());
+    }
+    QResampler<T> resampler(signal.clock(), clock);
+    return resampler.process(signal);
+}
+
+// Целочисленная модель CIC фильтра: N интеграторов и N гребенчатых фильтров с
+// дифференциальной задержкой D, между которыми частота дискретизации
+// понижается (дециматор) или повышается (интерполятор) в R раз. Регистры
+// имеют разрядность registerWidth() = inputBits + ceil(log2(gain())) (рост
+// разрядности по Хогенауэру) и переполняются по модулю, как в ПЛИС: вычисления
+// ведутся по модулю 2^64, а выход приводится к registerWidth() разрядам со
+// знаком, что даёт тот же результат, что и регистры этой разрядности.
+class QCicState {
+public:
+    enum class Type {Decimator, Interpolator};
+
+    QCicState(Type type, int order, int factor, int delay, int inputBits);
+    // Возвращает количество выходов, записанных в output
+    int process(const qint64* input, int size, qint64* output);
+    // Количество выходов, которое будет получено после поступления samples отсчётов
+    int outputCount(int samples) const;
+    void reset();
+    Type type() const { return type_; }
+    int order() const { return order_; }
+    int factor() const { return factor_; }
+    int delay() const { return delay_; }
+    int inputBits() const { return inputBits_; }
+    int registerWidth() const { return registerWidth_; }
+    // Коэффициент передачи на нулевой частоте: (R*D)^N для дециматора,
+    // (R*D)^N / R для интерполятора
+    double gain() const { return gain_; }
+private:
+    quint64 comb_(quint64 x);
+    qint64 signExtend_(quint64 x) const;
+
+private:
+    Type type_;
+    int order_;
+    int factor_;
+    int delay_;
+    int inputBits_;
+    int registerWidth_;
+    double gain_;
+    QVector<quint64> integrators_;
+    // Линии задержки гребенчатых фильтров по delay отсчётов
+    QVector<quint64> combs_;
+    int combPosition_ = 0;
+    // Номер входного отсчёта дециматора в периоде R
+    int phase_ = 0;
+};
+
+// Коэффициенты КИХ фильтра size отсчётов, компенсирующего спад АЧХ CIC
+// фильтра в полосе [0, passband] (в долях низкой частоты дискретизации CIC
+// фильтра, passband < 0.5). Коэффициент передачи на нулевой частоте равен 1.
+QRealSignal cicCompensationFilter(int order, int factor, int delay, int size, double passband = 0.25);
+
+namespace detail {
+
+// Общая часть CIC дециматора и интерполятора для сигналов: отсчёты
+// квантуются в inputBits разрядов (полная шкала - [-1, 1)), результат
+// нормируется на коэффициент передачи, поэтому масштаб сигнала сохраняется.
+// Действительная и мнимая части обрабатываются независимыми каналами.
+template<class S>
+class QBasicCic {
+public:
+    template<class C, class = std::enable_if_t<isSignalContainer<C>>>
+    S process(const C& chunk)
+    {
+        S result;
+        this->process(chunk, result);
+        return result;
+    }
+    template<class C, class = std::enable_if_t<isSignalContainer<C>>>
+    void process(const C& chunk, S& result)
+    {
+        static_assert(std::is_same<typename C::value_type, typename S::value_type>::value,
+                      "Chunk must have the same sample type as the filter");
+        QFrequency clock = chunk.clock();
+        // Компенсирующий фильтр работает на низкой частоте дискретизации:
+        // после дециматора и перед интерполятором
+        if (compensation_ && channels_[0].type() == QCicState::Type::Interpolator) {
+            compensation_->process(chunk, compensated_);
+            this->process_(compensated_, clock, result);
+        } else {
+            this->process_(chunk, clock, result);
+        }
+        if (compensation_ && channels_[0].type() == QCicState::Type::Decimator) {
+            compensation_->transform(result);
+        }
+    }
+    // Компенсирующий КИХ фильтр, например cicCompensationFilter
+    void setCompensation(const QRealSignal& coefficients) { compensation_.emplace(coefficients); }
+    void resetCompensation() { compensation_.reset(); }
+    bool hasCompensation() const { return compensation_.has_value(); }
+    int outputCount(int samples) const { return channels_[0].outputCount(samples); }
+    // Обнуляет регистры и линию задержки компенсирующего фильтра
+    void reset()
+    {
+        for (QCicState& channel: channels_) {
+            channel.reset();
+        }
+        if (compensation_) {
+            compensation_->reset();
+        }
+    }
+    int order() const { return channels_[0].order(); }
+    int factor() const { return channels_[0].factor(); }
+    int delay() const { return channels_[0].delay(); }
+    int inputBits() const { return channels_[0].inputBits(); }
+    int registerWidth() const { return channels_[0].registerWidth(); }
+    double gain() const { return channels_[0].gain(); }
+
+protected:
+    QBasicCic(QCicState::Type type, int order, int factor, int delay, int inputBits)
+        : channels_(channelCount_, QCicState(type, order, factor, delay, inputBits))
+    {
+        // Полная шкала 2^(inputBits - 1) должна умещаться в qint64
+        if (inputBits > 63) {
+            throw std::invalid_argument("CIC filter input must have at most 63 bits");
+        }
+        fullScale_ = qint64(1) << (inputBits - 1);
+    }
+
+private:
+    template<class C>
+    void process_(const C& chunk, QFrequency clock, S& result)
+    {
+        int size = chunk.size();
+        int count = this->outputCount(size);
+        bool decimator = channels_[0].type() == QCicState::Type::Decimator;
+        result.resize(count);
+        result.setClock(decimator ? clock / this->factor() : clock * this->factor());
+        input_.resize(size);
+        output_.resize(count);
+        double scale = 1.0 / (this->gain() * fullScale_);
+        for (int c = 0; c < channelCount_; ++c) {
+            for (int i = 0; i < size; ++i) {
+                QReal x = c == 0 ? std::real(chunk[i]) : std::imag(chunk[i]);
+                // Ограничение до округления исключает переполнение llround
+                qint64 q = llround(std::clamp<QReal>(x, -1, 1)*fullScale_);
+                input_[i] = std::clamp<qint64>(q, -fullScale_, fullScale_ - 1);
+            }
+            channels_[c].process(input_.constData(), size, output_.data());
+            for (int j = 0; j < count; ++j) {
+                if constexpr (isComplexSignalContainer<S>) {
+                    QReal y = output_[j]*scale;
+                    result[j] = c == 0 ? QComplex(y, 0) : QComplex(result[j].real(), y);
+                } else {
+                    result[j] = output_[j]*scale;
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr int channelCount_ = isComplexSignalContainer<S> ? 2 : 1;
+    QVector<QCicState> channels_;
+    qint64 fullScale_ = 0;
+    std::optional<QFirFilter<QRealSignal, S>> compensation_;
+    S compensated_;
+    QVector<qint64> input_;
+    QVector<qint64> output_;
+};
+
+} // namespace detail
+
+// Потоковый CIC дециматор (см. QCicState): интеграторы работают на входной
+// частоте дискретизации, гребенчатые фильтры - на выходной, в factor раз
+// меньшей. Выход формируется на каждом factor-м отсчёте, начиная с первого.
+// Компенсирующий фильтр, если задан, применяется к выходу.
+template<class S, class = std::enable_if_t<isSignalBased<S>>>
+class QCicDecimator: public detail::QBasicCic<S> {
+public:
+    QCicDecimator(int order, int factor, int delay = 1, int inputBits = 16)
+        : detail::QBasicCic<S>(QCicState::Type::Decimator, order, factor, delay, inputBits)
+    {}
+};
+
+// Потоковый CIC интерполятор (см. QCicState): гребенчатые фильтры работают на
+// входной частоте дискретизации, интеграторы - на выходной, в factor раз
+// большей. Компенсирующий фильтр, если задан, применяется ко входу.
+template<class S, class = std::enable_if_t<isSignalBased<S>>>
+class QCicInterpolator: public detail::QBasicCic<S> {
+public:
+    QCicInterpolator(int order, int factor, int delay = 1, int inputBits = 16)
+        : detail::QBasicCic<S>(QCicState::Type::Interpolator, order, factor, delay, inputBits)
+    {}
+};
+
+// Звено второго порядка (биквадратный фильтр) с передаточной функцией
+// (b0 + b1*z^-1 + b2*z^-2) / (1 + a1*z^-1 + a2*z^-2). Звено первого порядка
+// задаётся нулевыми b2 и a2.
+struct QBiquad {
+    QReal b0;
+    QReal b1;
+    QReal b2;
+    QReal a1;
+    QReal a2;
+};
+
+// Расчёт каскадов звеньев второго порядка по классическим аналоговым
+// прототипам с билинейным преобразованием и предыскажением частот среза.
+// Фильтр Чебышёва I рода имеет пульсации ripple дБ в полосе пропускания,
+// cutoff - граница полосы пропускания. Полосовые фильтры имеют порядок 2*order.
+// Для недопустимых параметров выбрасывается исключение std::invalid_argument.
+QVector<QBiquad> butterworthLowPass(int order, QFrequency cutoff, QFrequency clock);
+QVector<QBiquad> butterworthHighPass(int order, QFrequency cutoff, QFrequency clock);
+QVector<QBiquad> butterworthBandPass(int order, QFrequency low, QFrequency high, QFrequency clock);
+QVector<QBiquad> chebyshevLowPass(int order, double ripple, QFrequency cutoff, QFrequency clock);
+QVector<QBiquad> chebyshevHighPass(int order, double ripple, QFrequency cutoff, QFrequency clock);
+QVector<QBiquad> chebyshevBandPass(int order, double ripple, QFrequency low, QFrequency high, QFrequency clock);
+
+// Комплексный коэффициент передачи каскада на частоте frequency
+QComplex frequencyResponse(const QVector<QBiquad>& sections, QFrequency frequency, QFrequency clock);
+
+namespace detail {
+
+// Каскад звеньев в транспонированной второй прямой форме для lanes
+// независимых действительных каналов с чередующимися отсчётами
+// data[t*lanes + lane], обработка на месте. Каналы обрабатываются параллельно
+// в векторных регистрах (см. SimdInstructionSet). state хранит по 2*lanes
+// значений на звено.
+void biquadCascade(const QBiquad* sections, int sectionCount, QReal* state, QReal* data, int samples, int lanes);
+
+} // namespace detail
+
+// Потоковый БИХ фильтр - каскад звеньев второго порядка для channels
+// сигналов типа S (QRealSignal или QComplexSignal). Состояние звеньев
+// сохраняется между вызовами process. Каналы, а для комплексных сигналов и
+// действительные и мнимые части, обрабатываются одновременно в разных
+// элементах векторных регистров.
+template<class S, class = std::enable_if_t<isSignalBased<S>>>
+class QBiquadCascade {
+public:
+    explicit QBiquadCascade(const QVector<QBiquad>& sections, int channels = 1)
+        : sections_(sections), channels_(channels)
+    {
+        if (sections.isEmpty() || channels <= 0) {
+            throw std::invalid_argument("Biquad cascade must have sections and channels");
+        }
+        state_.resize(2*sections.size()*lanes_());
+        this->reset();
+    }
+    // Обработка одноканального каскада
+    template<class C, class = std::enable_if_t<isSignalContainer<C>>>
+    S process(const C& chunk)
+    {
+        S result;
+        this->process(chunk, result);
+        return result;
+    }
+    template<class C, class = std::enable_if_t<isSignalContainer<C>>>
+    void process(const C& chunk, S& result)
+    {
+        if (channels_ != 1) {
+            throw std::invalid_argument("Multichannel biquad cascade requires a chunk per channel");
+        }
+        const C* chunks[] = {&chunk};
+        S* results[] = {&result};
+        this->process_(chunks, results);
+    }
+    void transform(S& signal) { this->process(signal, signal); }
+    // Обработка многоканального каскада: по фрагменту одинаковой длины на канал
+    template<class C, class = std::enable_if_t<isSignalContainer<C>>>
+    QVector<S> process(const QVector<C>& chunks)
+    {
+        QVector<S> results;
+        this->process(chunks, results);
+        return results;
+    }
+    template<class C, class = std::enable_if_t<isSignalContainer<C>>>
+    void process(const QVector<C>& chunks, QVector<S>& results)
+    {
+        if (chunks.size() != channels_) {
+            throw std::invalid_argument("Chunk count must be equal to the channel count");
+        }
+        results.resize(channels_);
+        QVector<const C*> chunkPointers(channels_);
+        QVector<S*> resultPointers(channels_);
+        for (int c = 0; c < channels_; ++c) {
+            chunkPointers[c] = &chunks[c];
+            resultPointers[c] = &results[c];
+        }
+        this->process_(chunkPointers.data(), resultPointers.data());
+    }
+    // Обнуляет состояние звеньев всех каналов
+    void reset() { state_.fill(0); }
+    const QVector<QBiquad>& sections() const { return sections_; }
+    int channels() const { return channels_; }
+
+private:
+    static constexpr int blockValues_ = 1 << 13;
+    int lanes_() const { return (isComplexSignalContainer<S> ? 2 : 1)*channels_; }
+    template<class C>
+    void process_(const C* const* chunks, S* const* results)
+    {
+        static_assert(std::is_same<typename C::value_type, typename S::value_type>::value,
+                      "Chunk must have the same sample type as the filter");
+        int size = chunks[0]->size();
+        for (int c = 1; c < channels_; ++c) {
+            if (chunks[c]->size() != size) {
+                throw std::invalid_argument("Channel chunks must have the same size");
+            }
+        }
+        int lanes = lanes_();
+        QVector<const typename C::value_type*> inputs(channels_);
+        QVector<typename S::value_type*> outputs(channels_);
+        for (int c = 0; c < channels_; ++c) {
+            inputs[c] = chunks[c]->data();
+        }
+        // Выходы подготавливаются после запоминания входов, поэтому допускается
+        // обработка на месте: каждый блок читается до записи результата
+        for (int c = 0; c < channels_; ++c) {
+            QFrequency clock = chunks[c]->clock();
+            results[c]->resize(size);
+            results[c]->setClock(clock);
+            outputs[c] = results[c]->data();
+        }
+        // Отсчёты каналов чередуются блоками, остающимися в кэше при проходе
+        // по всем звеньям каскада
+        int blockSamples = std::max(1, blockValues_ / lanes);
+        buffer_.resize(blockSamples*lanes);
+        QReal* buffer = buffer_.data();
+        for (int first = 0; first < size; first += blockSamples) {
+            int count = std::min(blockSamples, size - first);
+            for (int c = 0; c < channels_; ++c) {
+                const typename C::value_type* input = inputs[c] + first;
+                for (int i = 0; i < count; ++i) {
+                    if constexpr (isComplexSignalContainer<S>) {
+                        buffer[i*lanes + 2*c] = input[i].real();
+                        buffer[i*lanes + 2*c + 1] = input[i].imag();
+                    } else {
+                        buffer[i*lanes + c] = input[i];
+                    }
+                }
+            }
+            detail::biquadCascade(sections_.constData(), sections_.size(), state_.data(), buffer, count, lanes);
+            for (int c = 0; c < channels_; ++c) {
+                typename S::value_type* output = outputs[c] + first;
+                for (int i = 0; i < count; ++i) {
+                    if constexpr (isComplexSignalContainer<S>) {
+                        output[i] = QComplex(buffer[i*lanes + 2*c], buffer[i*lanes + 2*c + 1]);
+                    } else {
+                        output[i] = buffer[i*lanes + c];
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    QVector<QBiquad> sections_;
+    int channels_;
+    QVector<QReal> state_;
+    QVector<QReal> buffer_;
+};
+
 template<class T, class = std::enable_if_t<isSignalContainer<T>>>
 auto cicFilter(const T &signal, int order, int delay)
 {
     if (order <= 0 || delay <= 0) {
-        return detail::SignalResult<T, T>(signal.clock(), 0);
+        return detail::SignalResult<T, T>(0, signal.clock());
     }
-    detail::SignalResult<T, T> result(signal.clock(), signal.size());
+    detail::SignalResult<T, T> result(signal.size(), signal.clock());
     std::copy(signal.begin(), signal.end(), result.begin());
 
     //Проходим N раз связку интегратор-гребенчатый фильтр
@@ -1714,16 +2549,16 @@ auto cicFilter(const T &signal, int order, int delay)
 template<class T, class = std::enable_if_t<isSignalContainer<T>>>
 auto decimate(const T &signal, int factor, bool accumulate = false, bool average = false)
 {
-    detail::SignalResult<T, T> result(signal.clock() / factor, signal.size() / factor);
+    detail::SignalResult<T, T> result(signal.size() / factor, signal.clock() / factor);
     if (accumulate) {
         for (int i = 0; i < result.size(); ++i) {
             result[i] = std::accumulate(signal.begin()+factor*i,
                                         signal.begin()+factor*(i+1),
-                                        0,
+                                        typename detail::SignalResult<T, T>::value_type(),
                                         [=](auto sum, auto discrete)
             {
                 return sum += discrete ;
-            }) / (average ? factor : 1);
+            }) / QReal(average ? factor : 1);
         }
     } else {
         for (int i = 0; i < result.size(); ++i) {
@@ -1733,66 +2568,341 @@ auto decimate(const T &signal, int factor, bool accumulate = false, bool average
     return result;
 }
 
-// Дискретное преобразование Фурье является относительно медленным алгоритмом,
-// поэтому для высокопроизводительного кода следует использовать
-// быстрое преобразование Фурье (QFft)
-template<class T, class = std::enable_if_t<isSignalContainer<T>>>
-QComplexSignal dft(const T &signal, int size, bool inverted = false)
-{
-    int resultSize = (signal.size() > size) ? size : signal.size();
-    QComplexSignal result(resultSize, signal.clock());
-    for (int i = 0; i < resultSize; ++i) {
-        QComplexSignal complexExponent = QComplexSignal::harmonic(resultSize, (double)(inverted ? i : -i) / resultSize);
-        result[i] = (inverted ? 1 : (1.0/resultSize)) * detail::basicConvolution(signal.begin(), signal.begin() + resultSize, complexExponent.begin());
-    }
-    return result;
-}
+namespace detail {
+
+template<class T>
+inline constexpr bool isStdComplex = false;
+
+template<class T>
+inline constexpr bool isStdComplex<std::complex<T>> = true;
+
+// Перестановка отсчётов в бит-реверсном порядке. Для небольших размерностей
+// используется таблица индексов, для больших - поблочная перестановка
+// (COBRA), при которой и чтение, и запись идут непрерывными отрезками.
+class QBitReversal {
+public:
+    QBitReversal() = default;
+    explicit QBitReversal(int power);
+    int power() const { return power_; }
+    int size() const { return power_ == 0 ? 0 : 1 << power_; }
+    int reversed(int index) const;
+    // Реализованы для std::complex<float> и std::complex<double>
+    template<class Complex>
+    void copy(const Complex* source, Complex* destination) const;
+    template<class Complex>
+    void apply(Complex* data) const;
+
+private:
+    static constexpr int blockPower_ = 4;
+    static constexpr int minBlockedPower_ = 16;
+
+    int power_ = 0;
+    bool blocked_ = false;
+    QVector<int> table_;
+    QVector<int> blockTable_;
+};
+
+} // namespace detail
+
+// Сигналы точности T, используемые БПФ. Для T = QReal это QRealSignal и
+// QComplexSignal, для другой точности - контейнеры отсчётов с частотой
+// дискретизации только для передачи данных в БПФ и из него: арифметика
+// сигналов, окна и алгоритмы для них не определены, для дальнейшей обработки
+// результат копируется в QRealSignal или QComplexSignal.
+template<class T>
+using QBasicRealSignal = std::conditional_t<std::is_same<T, QReal>::value,
+                                            QRealSignal, detail::QSignal<T>>;
+
+template<class T>
+using QBasicComplexSignal = std::conditional_t<std::is_same<T, QReal>::value,
+                                               QComplexSignal, detail::QSignal<std::complex<T>>>;
+
+template <typename T>
+inline constexpr bool isAnyRealSignalContainer = isRealSignalContainer<T> ||
+        std::is_base_of<detail::QSignal<float>, T>::value ||
+        std::is_base_of<detail::QSignal<double>, T>::value;
 
-class QFft: public QObject {
+template <typename T>
+inline constexpr bool isAnyComplexSignalContainer = isComplexSignalContainer<T> ||
+        std::is_base_of<detail::QSignal<std::complex<float>>, T>::value ||
+        std::is_base_of<detail::QSignal<std::complex<double>>, T>::value;
+
+template <typename T>
+inline constexpr bool isAnySignalContainer = isAnyRealSignalContainer<T> || isAnyComplexSignalContainer<T>;
+
+// Наборы команд, для которых имеются векторизованные бабочки БПФ и ядра
+// КИХ и БИХ фильтров. Набор выбирается при работе программы по результатам CPUID,
+// поэтому сборка не требует специальных ключей компилятора.
+enum class SimdInstructionSet {Scalar, SSE2, AVX2, AVX512};
+
+// Поддерживается ли набор команд процессором и компилятором
+bool isSimdInstructionSetSupported(SimdInstructionSet instructionSet);
+// Наилучший набор команд, поддерживаемый процессором и компилятором
+SimdInstructionSet supportedSimdInstructionSet();
+// Набор команд, используемый БПФ, КИХ и БИХ фильтрами. По умолчанию -
+// наилучший поддерживаемый.
+SimdInstructionSet simdInstructionSet();
+// Выбор набора команд, например для сравнения результатов со скалярной
+// реализацией. Для неподдерживаемого набора выбрасывается исключение.
+void setSimdInstructionSet(SimdInstructionSet instructionSet);
+
+// Количество потоков, используемых пакетным БПФ и БПФ большой размерности.
+// По умолчанию равно количеству ядер процессора, значение 1 отключает
+// многопоточность.
+int fftThreadCount();
+void setFftThreadCount(int count);
+
+namespace detail {
+
+// Выполняет task(i) для всех i из [0, count) в пуле потоков БПФ, вызывающий
+// поток также участвует в вычислениях. Вложенные вызовы и вызовы, сделанные
+// пока пул занят другим потоком, выполняются в вызывающем потоке.
+void parallelFor(int count, const std::function<void(int)>& task);
+
+// Поблочное транспонирование матрицы rows x columns, хранящейся по строкам.
+// Большие матрицы транспонируются в пуле потоков БПФ. Реализовано для
+// std::complex<float> и std::complex<double>.
+template<class Complex>
+void transpose(const Complex* source, Complex* destination, int rows, int columns);
+
+} // namespace detail
+
+// ДПФ произвольной размерности без нормировки. Для размерностей, являющихся
+// степенью 2, используются каскады radix-4, для размерностей, раскладываемых
+// на множители 2, 3, 4, 5 и 7, - алгоритм Стокхэма со смешанным основанием,
+// для остальных - алгоритм Блюстейна.
+// План не изменяется после создания, поэтому один экземпляр может
+// использоваться несколькими потоками одновременно, если каждый поток
+// передаёт собственный рабочий буфер.
+// Движок БПФ параметризован точностью вычислений T (float или double) и не
+// зависит от QDSP_FLOAT_DISCRETE: планы, кэши и рабочие буферы разной
+// точности существуют одновременно. Для float векторные бабочки
+// обрабатывают вдвое больше отсчётов за команду. Имена без префикса Basic
+// (QFft, QFftPlan и т.д.) соответствуют точности QReal.
+template<class T>
+class QBasicFftPlan {
+    static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value,
+                  "FFT precision must be float or double");
+public:
+    using Complex = std::complex<T>;
+
+    QBasicFftPlan() = default;
+    explicit QBasicFftPlan(int size);
+    int size() const { return size_; }
+    // Размер рабочего буфера в комплексных отсчётах
+    int workspaceSize() const { return workspaceSize_; }
+    // Результат в естественном порядке записывается в output. Содержимое
+    // data не сохраняется, data и output не должны совпадать.
+    void transform(Complex* data, Complex* output, Complex* workspace) const;
+
+private:
+    enum class Algorithm { Radix4, MixedRadix, Bluestein, FourStep };
+
+    // Начиная с этой степени двойки данные не помещаются в кэш процессора и
+    // БПФ вычисляется по четырёхшаговой схеме
+    static constexpr int fourStepMinPower_ = 22;
+
+    void transformRadix4_(Complex* data, Complex* output) const;
+    void transformMixedRadix_(Complex* data, Complex* output, Complex* workspace) const;
+    void transformBluestein_(Complex* data, Complex* output, Complex* workspace) const;
+    void transformFourStep_(Complex* data, Complex* output, Complex* workspace) const;
+
+    int size_ = 0;
+    int power_ = 0;
+    int workspaceSize_ = 0;
+    Algorithm algorithm_ = Algorithm::Radix4;
+    QVector<int> factors_;
+    QVector<Complex> rotateMultiplers_;
+    detail::QBitReversal reversal_;
+    QVector<Complex> chirp_;
+    QVector<Complex> chirpSpectrum_;
+    std::shared_ptr<const QBasicFftPlan> bluesteinPlan_;
+    std::shared_ptr<const QBasicFftPlan> rowPlan_;
+    std::shared_ptr<const QBasicFftPlan> columnPlan_;
+};
+
+// Рабочие буферы БПФ. Буферы только увеличиваются, поэтому при повторных
+// вычислениях с одним экземпляром память не выделяется. Экземпляр не должен
+// использоваться несколькими потоками одновременно.
+template<class T>
+class QBasicFftWorkspace {
 public:
-    explicit QFft(bool inverted = false)
+    using Complex = std::complex<T>;
+
+    QBasicFftWorkspace() = default;
+    explicit QBasicFftWorkspace(const QBasicFftPlan<T>& plan) { this->reserve(plan); }
+    void reserve(const QBasicFftPlan<T>& plan);
+    Complex* input() { return input_.data(); }
+    Complex* output() { return output_.data(); }
+    Complex* scratch() { return scratch_.data(); }
+
+    // Буферы, используемые вызовами без явно переданного рабочего буфера
+    static QBasicFftWorkspace& threadLocal();
+
+private:
+    QVector<Complex> input_;
+    QVector<Complex> output_;
+    QVector<Complex> scratch_;
+};
+
+// Общий для процесса кэш планов БПФ, для каждой точности - свой. Планы не
+// зависят от направления преобразования (обратное БПФ вычисляется через
+// прямое), поэтому ключом является размерность. Функции кэша могут
+// вызываться одновременно из нескольких потоков.
+template<class T>
+class QBasicFftPlanCache {
+public:
+    QBasicFftPlanCache() = delete;
+    // Возвращает план из кэша, при отсутствии - создаёт его и сохраняет в кэше
+    static std::shared_ptr<const QBasicFftPlan<T>> plan(int size);
+    // Количество планов в кэше
+    static int count();
+    // Количество обращений, обслуженных кэшем, и количество созданных планов
+    static quint64 hits();
+    static quint64 misses();
+    // Удаляет планы из кэша. Планы, используемые экземплярами QFft, остаются
+    // действительными до их уничтожения.
+    static void clear();
+    static void resetStatistics();
+};
+
+// Аргументом может быть сигнал любой точности, результат имеет точность T
+template<class T>
+class QBasicFft: public QObject {
+public:
+    using Complex = std::complex<T>;
+    using ComplexSignal = QBasicComplexSignal<T>;
+    using Plan = QBasicFftPlan<T>;
+    using Workspace = QBasicFftWorkspace<T>;
+
+    explicit QBasicFft(bool inverted = false)
         : inverted_(inverted)
     {}
-    explicit QFft(int size, bool inverted = false);
-    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
-    QComplexSignal compute(const T& signal) const
+    explicit QBasicFft(int size, bool inverted = false);
+    explicit QBasicFft(std::shared_ptr<const Plan> plan, bool inverted = false);
+    // Вычисления используют рабочие буферы текущего потока, поэтому один
+    // экземпляр может использоваться несколькими потоками одновременно
+    template<class S, class = std::enable_if_t<isAnySignalContainer<S>>>
+    ComplexSignal compute(const S& signal) const
+    { return this->compute(signal, Workspace::threadLocal()); }
+    template<class S, class = std::enable_if_t<isAnySignalContainer<S>>>
+    ComplexSignal compute(const S& signal, Workspace& workspace) const
     {
-        if (fftPower_ == 0) {
-            return QComplexSignal(signal.clock());
-        }
-        // Расчёт обратного БПФ ведём путём перемены местами re и im на входе и выходе
-        for (int i = 0; i < fftSize_; ++i) {
-            if constexpr (isComplexSignalContainer<T>) {
-                buffer_[i] = (i < signal.size()) ? (inverted_ ? QComplex(signal[i].imag(), signal[i].real()) : signal[i]) : 0;
-            } else {
-                buffer_[i] = (i < signal.size()) ? (inverted_ ? QComplex(0, signal[i]) : signal[i]) : 0;
-            }
+        ComplexSignal result;
+        this->compute(signal, result, workspace);
+        return result;
+    }
+    // Результат записывается в result без выделения памяти, если размер
+    // result уже равен размерности БПФ. Аргумент и результат могут совпадать.
+    template<class S, class = std::enable_if_t<isAnySignalContainer<S>>>
+    void compute(const S& signal, ComplexSignal& result) const
+    { this->compute(signal, result, Workspace::threadLocal()); }
+    template<class S, class = std::enable_if_t<isAnySignalContainer<S>>>
+    void compute(const S& signal, ComplexSignal& result, Workspace& workspace) const
+    { this->computeRange_(signal, 0, signal.size(), result, workspace); }
+    // БПФ на месте: размер сигнала приводится к размерности БПФ
+    void transform(ComplexSignal& signal) const
+    { this->compute(signal, signal); }
+    void transform(ComplexSignal& signal, Workspace& workspace) const
+    { this->compute(signal, signal, workspace); }
+
+    // Пакетное БПФ каналов, для каждого из которых выполняется одинаковое
+    // преобразование. Каналы распределяются между потоками пула (см.
+    // setFftThreadCount), каждый поток использует собственный рабочий буфер.
+    template<class S, class = std::enable_if_t<isAnySignalContainer<S>>>
+    QVector<ComplexSignal> computeBatch(const QVector<S>& channels) const
+    {
+        QVector<ComplexSignal> results;
+        this->computeBatch(channels, results);
+        return results;
+    }
+    template<class S, class = std::enable_if_t<isAnySignalContainer<S>>>
+    void computeBatch(const QVector<S>& channels, QVector<ComplexSignal>& results) const
+    {
+        results.resize(channels.size());
+        ComplexSignal* result = results.data();
+        this->processBatch_(channels.size(), [&](int i) { this->compute(channels[i], result[i]); });
+    }
+    // Каналы расположены в block друг за другом: канал i начинается с
+    // отсчёта i*stride и содержит не более stride отсчётов
+    template<class S, class = std::enable_if_t<isAnySignalContainer<S>>>
+    QVector<ComplexSignal> computeBatch(const S& block, int channelCount, int stride) const
+    {
+        QVector<ComplexSignal> results;
+        this->computeBatch(block, channelCount, stride, results);
+        return results;
+    }
+    template<class S, class = std::enable_if_t<isAnySignalContainer<S>>>
+    void computeBatch(const S& block, int channelCount, int stride, QVector<ComplexSignal>& results) const
+    {
+        if (channelCount < 0 || stride < 0) {
+            throw std::invalid_argument("Channel count and stride must be positive");
         }
-        return this->process_(signal.clock());
+        results.resize(channelCount);
+        ComplexSignal* result = results.data();
+        this->processBatch_(channelCount, [&](int i) {
+            int start = std::min((qint64)i*stride, (qint64)block.size());
+            this->computeRange_(block, start, std::min<qint64>(stride, block.size() - start),
+                                result[i], Workspace::threadLocal());
+        });
     }
 
     void setPower(int power);
     int power() const { return fftPower_; }
-    void setSize(int size){ this->setPower(floor(log2(size))); }
+    void setSize(int size);
     int size() const { return fftSize_; }
     void setInverted(bool inverted){ inverted_ = inverted; }
     bool inverted() const { return inverted_; }
-    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
-    QComplexSignal operator()(const T& signal) const
+    const std::shared_ptr<const Plan>& plan() const { return plan_; }
+    void setPlan(std::shared_ptr<const Plan> plan);
+    template<class S, class = std::enable_if_t<isAnySignalContainer<S>>>
+    ComplexSignal operator()(const S& signal) const
     { return this->compute(signal); }
 private:
-    static int reverseBits_(int number, int bitCount);
-    void updateRotateMultiplers_();
-    QComplexSignal process_(QFrequency resultBandwidth) const;
+    // БПФ отсчётов [offset, offset + count) сигнала
+    template<class S>
+    void computeRange_(const S& signal, int offset, int count, ComplexSignal& result, Workspace& workspace) const
+    {
+        QFrequency clock = signal.clock();
+        if (fftSize_ == 0) {
+            result.resize(0);
+            result.setClock(clock);
+            return;
+        }
+        workspace.reserve(*plan_);
+        Complex* buffer = workspace.input();
+        // Расчёт обратного БПФ ведём путём перемены местами re и im на входе и выходе
+        for (int i = 0; i < fftSize_; ++i) {
+            if (i >= count) {
+                buffer[i] = 0;
+            } else if constexpr (isAnyComplexSignalContainer<S>) {
+                const auto& discrete = signal[offset + i];
+                buffer[i] = inverted_ ? Complex(discrete.imag(), discrete.real()) : Complex(discrete);
+            } else {
+                buffer[i] = inverted_ ? Complex(0, signal[offset + i]) : Complex(signal[offset + i]);
+            }
+        }
+        result.resize(fftSize_);
+        result.setClock(clock);
+        this->process_(result.data(), workspace);
+    }
+    void process_(Complex* result, Workspace& workspace) const;
+    void processBatch_(int channelCount, const std::function<void(int)>& task) const;
 
 private:
     int fftPower_ = 0;
     int fftSize_ = 0;
     bool inverted_ = false;
-    QComplexSignal rotateMultiplers_;
-    mutable QComplexSignal buffer_;
+    std::shared_ptr<const Plan> plan_ = std::make_shared<const Plan>();
 };
 
+using QFftPlan = QBasicFftPlan<QReal>;
+using QFftWorkspace = QBasicFftWorkspace<QReal>;
+using QFftPlanCache = QBasicFftPlanCache<QReal>;
+using QFft = QBasicFft<QReal>;
+using QFloatFft = QBasicFft<float>;
+using QDoubleFft = QBasicFft<double>;
+
 template<class T, class = std::enable_if_t<isSignalContainer<T>>>
 QComplexSignal fft(const T &signal, int size, bool inverted = false)
 {
@@ -1800,6 +2910,451 @@ QComplexSignal fft(const T &signal, int size, bool inverted = false)
     return fft(signal);
 }
 
+// ДПФ размерности min(size, signal.size()) без дополнения нулями. Вычисляется
+// через QFft, поэтому размерность может быть произвольной; нормировка та же:
+// прямое преобразование делится на размерность, обратное - нет.
+template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+QComplexSignal dft(const T &signal, int size, bool inverted = false)
+{
+    QFft fft(std::min(size, signal.size()), inverted);
+    return fft(signal);
+}
+
+// БПФ действительного сигнала размерности N, вычисляемое через комплексное БПФ
+// размерности N/2: чётные отсчёты упаковываются в действительную часть,
+// нечётные - в мнимую (для нечётных N - через комплексное БПФ размерности N).
+// Результат - половина спектра (N/2 + 1 отсчётов, остальные комплексно
+// сопряжены) или полный спектр, нормирован так же, как результат прямого
+// QFft. Обратное преобразование восстанавливает действительный сигнал
+// по половине спектра.
+template<class T>
+class QBasicRealFft: public QObject {
+public:
+    using Complex = std::complex<T>;
+    using RealSignal = QBasicRealSignal<T>;
+    using ComplexSignal = QBasicComplexSignal<T>;
+    using Plan = QBasicFftPlan<T>;
+    using Workspace = QBasicFftWorkspace<T>;
+
+    explicit QBasicRealFft(bool fullSpectrum = false)
+        : fullSpectrum_(fullSpectrum)
+    {}
+    explicit QBasicRealFft(int size, bool fullSpectrum = false);
+    template<class S, class = std::enable_if_t<isAnyRealSignalContainer<S>>>
+    ComplexSignal compute(const S& signal) const
+    { return this->compute(signal, Workspace::threadLocal()); }
+    template<class S, class = std::enable_if_t<isAnyRealSignalContainer<S>>>
+    ComplexSignal compute(const S& signal, Workspace& workspace) const
+    {
+        ComplexSignal result;
+        this->compute(signal, result, workspace);
+        return result;
+    }
+    template<class S, class = std::enable_if_t<isAnyRealSignalContainer<S>>>
+    void compute(const S& signal, ComplexSignal& result) const
+    { this->compute(signal, result, Workspace::threadLocal()); }
+    template<class S, class = std::enable_if_t<isAnyRealSignalContainer<S>>>
+    void compute(const S& signal, ComplexSignal& result, Workspace& workspace) const
+    {
+        result.setClock(signal.clock());
+        if (fftSize_ == 0) {
+            result.resize(0);
+            return;
+        }
+        workspace.reserve(*plan_);
+        Complex* buffer = workspace.input();
+        if (fftSize_ % 2 == 0) {
+            for (int i = 0; i < fftSize_/2; ++i) {
+                buffer[i] = Complex((2*i < signal.size()) ? signal[2*i] : 0,
+                                    (2*i + 1 < signal.size()) ? signal[2*i + 1] : 0);
+            }
+        } else {
+            for (int i = 0; i < fftSize_; ++i) {
+                buffer[i] = (i < signal.size()) ? signal[i] : 0;
+            }
+        }
+        result.resize(fullSpectrum_ ? fftSize_ : fftSize_/2 + 1);
+        this->process_(result.data(), workspace);
+    }
+    // Аргумент - половина спектра или полный спектр, используются
+    // первые N/2 + 1 отсчётов
+    template<class S, class = std::enable_if_t<isAnyComplexSignalContainer<S>>>
+    RealSignal inverse(const S& spectrum) const
+    { return this->inverse(spectrum, Workspace::threadLocal()); }
+    template<class S, class = std::enable_if_t<isAnyComplexSignalContainer<S>>>
+    RealSignal inverse(const S& spectrum, Workspace& workspace) const
+    {
+        RealSignal result;
+        this->inverse(spectrum, result, workspace);
+        return result;
+    }
+    template<class S, class = std::enable_if_t<isAnyComplexSignalContainer<S>>>
+    void inverse(const S& spectrum, RealSignal& result) const
+    { this->inverse(spectrum, result, Workspace::threadLocal()); }
+    template<class S, class = std::enable_if_t<isAnyComplexSignalContainer<S>>>
+    void inverse(const S& spectrum, RealSignal& result, Workspace& workspace) const
+    {
+        result.setClock(spectrum.clock());
+        if (fftSize_ == 0) {
+            result.resize(0);
+            return;
+        }
+        workspace.reserve(*plan_);
+        Complex* halfSpectrum = workspace.output();
+        for (int i = 0; i <= fftSize_/2; ++i) {
+            halfSpectrum[i] = (i < spectrum.size()) ? Complex(spectrum[i]) : Complex();
+        }
+        result.resize(fftSize_);
+        this->processInverse_(result.data(), workspace);
+    }
+
+    void setPower(int power);
+    int power() const { return fftPower_; }
+    void setSize(int size);
+    int size() const { return fftSize_; }
+    void setFullSpectrum(bool fullSpectrum){ fullSpectrum_ = fullSpectrum; }
+    bool fullSpectrum() const { return fullSpectrum_; }
+    template<class S, class = std::enable_if_t<isAnyRealSignalContainer<S>>>
+    ComplexSignal operator()(const S& signal) const
+    { return this->compute(signal); }
+private:
+    void process_(Complex* result, Workspace& workspace) const;
+    void processInverse_(T* result, Workspace& workspace) const;
+
+private:
+    int fftPower_ = 0;
+    int fftSize_ = 0;
+    bool fullSpectrum_ = false;
+    std::shared_ptr<const Plan> plan_ = std::make_shared<const Plan>();
+    QVector<Complex> rotateMultiplers_;
+};
+
+using QRealFft = QBasicRealFft<QReal>;
+using QFloatRealFft = QBasicRealFft<float>;
+using QDoubleRealFft = QBasicRealFft<double>;
+
+template<class T, class = std::enable_if_t<isRealSignalContainer<T>>>
+QComplexSignal realFft(const T &signal, int size, bool fullSpectrum = false)
+{
+    QRealFft fft(size, fullSpectrum);
+    return fft(signal);
+}
+
+namespace detail {
+
+// Резонаторы Гёрцеля s[n] = x[n] + c[k]*s[n-1] - s[n-2] для count частот,
+// векторизованные по частотам для набора команд simdInstructionSet().
+// s1 и s2 - значения s[n-1] и s[n-2], обновляются после обработки size отсчётов.
+void goertzelResonators(const QReal* coefficients, QReal* s1, QReal* s2, int count,
+                        const QReal* signal, int size);
+
+} // namespace detail
+
+// Алгоритм Гёрцеля для набора частот: значения спектра на заданных частотах
+// вычисляются за один проход по сигналу, частоты не обязаны совпадать с
+// отсчётами БПФ. Коэффициенты резонаторов рассчитываются при задании частот,
+// поэтому частота дискретизации сигнала задаётся вместе с ними. Нормировка
+// результата совпадает с нормировкой прямого QFft.
+class QGoertzel {
+public:
+    QGoertzel() = default;
+    QGoertzel(const QVector<QFrequency>& frequencies, QFrequency clock)
+    { this->setFrequencies(frequencies, clock); }
+    void setFrequencies(const QVector<QFrequency>& frequencies, QFrequency clock);
+    const QVector<QFrequency>& frequencies() const { return frequencies_; }
+    QFrequency clock() const { return clock_; }
+    // i-й отсчёт результата соответствует i-й частоте
+    template<class T, class = std::enable_if_t<isRealSignalContainer<T>>>
+    QComplexSignal compute(const T& signal) const
+    {
+        QComplexSignal result;
+        this->compute(signal, result);
+        return result;
+    }
+    // Сигнал без частоты дискретизации считается сигналом с частотой clock()
+    template<class T, class = std::enable_if_t<isRealSignalContainer<T>>>
+    void compute(const T& signal, QComplexSignal& result) const
+    {
+        if (signal.hasClock() && signal.clock() != clock_) {
+            throw std::invalid_argument("Signal clock must be equal to the Goertzel clock");
+        }
+        result.resize(frequencies_.size());
+        this->process_(signal.data(), signal.size(), result.data());
+    }
+    // Мощность |X|^2 на заданных частотах
+    template<class T, class = std::enable_if_t<isRealSignalContainer<T>>>
+    QRealSignal power(const T& signal) const
+    {
+        QComplexSignal spectrum = this->compute(signal);
+        QRealSignal result(spectrum.size());
+        std::transform(spectrum.begin(), spectrum.end(), result.begin(),
+                       [](QComplex x) { return std::norm(x); });
+        return result;
+    }
+    template<class T, class = std::enable_if_t<isRealSignalContainer<T>>>
+    QComplexSignal operator()(const T& signal) const
+    { return this->compute(signal); }
+private:
+    void process_(const QReal* signal, int size, QComplex* result) const;
+
+private:
+    QVector<QFrequency> frequencies_;
+    QFrequency clock_;
+    // Нормированные частоты f/clock, коэффициенты резонаторов 2*cos(w) и
+    // множители exp(-i*w)
+    QVector<double> normFrequencies_;
+    QVector<QReal> coefficients_;
+    QVector<QComplex> rotations_;
+};
+
+// Спектр в узкой полосе с высоким разрешением (ЛЧМ Z-преобразование):
+// binCount отсчётов с шагом span/binCount, центральный отсчёт binCount/2
+// соответствует частоте center. Вычисляется алгоритмом Блюстейна через
+// БПФ размерности не меньше size + binCount - 1 вместо БПФ размерности
+// clock/шаг, которое потребовалось бы для того же разрешения. Нормировка
+// совпадает с нормировкой прямого QFft.
+class QZoomFft {
+public:
+    QZoomFft() = default;
+    QZoomFft(int size, QFrequency clock, QFrequency center, QFrequency span, int binCount);
+    // Аргумент длиннее size усекается, короче - дополняется нулями
+    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+    QComplexSignal compute(const T& signal) const
+    { return this->compute(signal, QFftWorkspace::threadLocal()); }
+    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+    QComplexSignal compute(const T& signal, QFftWorkspace& workspace) const
+    {
+        QComplexSignal result;
+        this->compute(signal, result, workspace);
+        return result;
+    }
+    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+    void compute(const T& signal, QComplexSignal& result) const
+    { this->compute(signal, result, QFftWorkspace::threadLocal()); }
+    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+    void compute(const T& signal, QComplexSignal& result, QFftWorkspace& workspace) const
+    {
+        if (signal.hasClock() && signal.clock() != clock_) {
+            throw std::invalid_argument("Signal clock differs from zoom FFT clock");
+        }
+        result.setClock(clock_);
+        result.resize(binCount_);
+        if (binCount_ == 0) {
+            return;
+        }
+        workspace.reserve(*plan_);
+        QComplex* buffer = workspace.input();
+        int count = std::min(signal.size(), size_);
+        for (int n = 0; n < count; ++n) {
+            buffer[n] = chirp_[n] * signal[n];
+        }
+        std::fill(buffer + count, buffer + plan_->size(), QComplex());
+        this->process_(result.data(), workspace);
+    }
+    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+    QComplexSignal operator()(const T& signal) const
+    { return this->compute(signal); }
+
+    int size() const { return size_; }
+    QFrequency clock() const { return clock_; }
+    QFrequency center() const { return center_; }
+    QFrequency span() const { return span_; }
+    int binCount() const { return binCount_; }
+    // Частота отсчёта bin результата
+    QFrequency frequency(int bin) const
+    { return center_ + span_*((double)(bin - binCount_/2)/binCount_); }
+private:
+    void process_(QComplex* result, QFftWorkspace& workspace) const;
+
+private:
+    int size_ = 0;
+    int binCount_ = 0;
+    QFrequency clock_;
+    QFrequency center_;
+    QFrequency span_;
+    std::shared_ptr<const QFftPlan> plan_ = std::make_shared<const QFftPlan>();
+    QVector<QComplex> chirp_;
+    QVector<QComplex> filterSpectrum_;
+    QVector<QComplex> rotateMultiplers_;
+};
+
+// Спектр сигнала в полосе span вокруг center, см. QZoomFft
+template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+QComplexSignal zoomFft(const T &signal, QFrequency center, QFrequency span, int binCount)
+{
+    QZoomFft fft(signal.size(), signal.clock(), center, span, binCount);
+    return fft(signal);
+}
+
+// Скользящее ДПФ фрейма размером N: при сдвиге фрейма на один отсчёт спектр
+// обновляется рекурсивно, X[k] = (X[k] - x[n] + x[n+N]) * exp(2*pi*i*k/N), за
+// O(K) операций для K отслеживаемых отсчётов спектра. Окно задаётся
+// коэффициентами косинусного окна a[m] (w[n] = sum((-1)^m*a[m]*cos(2*pi*m*n/N)))
+// и применяется в частотной области свёрткой с ядром из 2M+1 отсчётов:
+// {0.5, 0.5} - окно Ханна, {0.54, 0.46} - окно Хэмминга, {0.42, 0.5, 0.08} -
+// окно Блэкмана. Нормировка совпадает с нормировкой прямого QFft.
+template<class T, class = std::enable_if_t<isSignalBased<T>>>
+class QSlidingDft {
+public:
+    using Frame = detail::QSignalFrame<T>;
+
+    // bins - отслеживаемые отсчёты спектра, пустой список - весь спектр
+    explicit QSlidingDft(const Frame& frame, const QVector<int>& bins = {})
+        : frame_(frame), bins_(bins)
+    {
+        this->setup_();
+    }
+    // Привязка к другому фрейму, спектр вычисляется заново
+    void attach(const Frame& frame)
+    {
+        frame_ = frame;
+        this->setup_();
+    }
+    const Frame& frame() const { return frame_; }
+    int size() const { return frame_.size(); }
+    const QVector<int>& bins() const { return bins_; }
+    void setWindow(const QVector<double>& coefficients)
+    {
+        window_ = coefficients;
+        this->setup_();
+    }
+    const QVector<double>& window() const { return window_; }
+
+    // Сдвигает фрейм на count отсчётов и обновляет спектр
+    void shift(int count = 1)
+    {
+        int size = frame_.size();
+        if (count < 0) {
+            throw std::invalid_argument("Sliding DFT can only shift forward");
+        }
+        if (frame_.position() + size + count > frame_.signalSize()) {
+            throw std::runtime_error("Sliding DFT frame is out of signal");
+        }
+        if (count >= size) {
+            frame_.shift(count);
+            this->refresh_();
+            return;
+        }
+        for (int i = 0; i < count; ++i) {
+            QComplex difference = (QComplex(frame_[size]) - QComplex(frame_[0])) / QReal(size);
+            frame_.shift();
+            QComplex* x = values_.data();
+            const QComplex* r = rotations_.constData();
+            for (int j = 0; j < values_.size(); ++j) {
+                QComplex y = x[j] + difference;
+                x[j] = QComplex(y.real()*r[j].real() - y.imag()*r[j].imag(),
+                                y.real()*r[j].imag() + y.imag()*r[j].real());
+            }
+            // Погрешность рекурсии накапливается, поэтому спектр
+            // периодически вычисляется заново
+            if (++shifts_ == refreshInterval_) {
+                this->refresh_();
+            }
+        }
+    }
+
+    // i-й отсчёт результата соответствует отсчёту bins()[i] (при
+    // отслеживании всего спектра - i-му отсчёту)
+    QComplexSignal spectrum() const
+    {
+        QComplexSignal result;
+        this->spectrum(result);
+        return result;
+    }
+    void spectrum(QComplexSignal& result) const
+    {
+        int reach = window_.isEmpty() ? 0 : window_.size() - 1;
+        int width = 2*reach + 1;
+        result.resize(neighbours_.size() / width);
+        result.setClock(frame_.clock());
+        for (int i = 0; i < result.size(); ++i) {
+            const int* neighbour = neighbours_.constData() + i*width + reach;
+            if (window_.isEmpty()) {
+                result[i] = values_[neighbour[0]];
+                continue;
+            }
+            QComplex y = QReal(window_[0]) * values_[neighbour[0]];
+            for (int m = 1; m <= reach; ++m) {
+                y += QReal((m % 2 ? -0.5 : 0.5) * window_[m]) *
+                        (values_[neighbour[-m]] + values_[neighbour[m]]);
+            }
+            result[i] = y;
+        }
+    }
+
+private:
+    static constexpr int refreshInterval_ = 1 << 20;
+
+    void setup_()
+    {
+        int size = frame_.size();
+        if (size <= 0) {
+            throw std::invalid_argument("Sliding DFT size must be positive");
+        }
+        if (frame_.position() < 0 || frame_.position() + size > frame_.signalSize()) {
+            throw std::runtime_error("Sliding DFT frame is out of signal");
+        }
+        // Отслеживаются заданные отсчёты и соседние с ними, необходимые для окна
+        int reach = window_.isEmpty() ? 0 : window_.size() - 1;
+        QVector<int> index(size, -1);
+        tracked_.clear();
+        neighbours_.clear();
+        for (int i = 0; i < (bins_.isEmpty() ? size : bins_.size()); ++i) {
+            int bin = bins_.isEmpty() ? i : bins_[i];
+            if (bin < 0 || bin >= size) {
+                throw std::invalid_argument("Sliding DFT bin is out of range");
+            }
+            for (int m = -reach; m <= reach; ++m) {
+                int k = ((bin + m) % size + size) % size;
+                if (index[k] < 0) {
+                    index[k] = tracked_.size();
+                    tracked_.append(k);
+                }
+                neighbours_.append(index[k]);
+            }
+        }
+        exponents_.resize(size);
+        for (int n = 0; n < size; ++n) {
+            exponents_[n] = QComplex(cos(2*M_PI*n/size), -sin(2*M_PI*n/size));
+        }
+        rotations_.resize(tracked_.size());
+        for (int j = 0; j < tracked_.size(); ++j) {
+            rotations_[j] = std::conj(exponents_[tracked_[j]]);
+        }
+        this->refresh_();
+    }
+    void refresh_()
+    {
+        int size = frame_.size();
+        values_.resize(tracked_.size());
+        if (tracked_.size() == size) {
+            QComplexSignal spectrum = QFft(size).compute(frame_);
+            for (int j = 0; j < tracked_.size(); ++j) {
+                values_[j] = spectrum[tracked_[j]];
+            }
+        } else {
+            for (int j = 0; j < tracked_.size(); ++j) {
+                QComplex sum;
+                for (int n = 0; n < size; ++n) {
+                    sum += frame_[n] * exponents_[(qint64)tracked_[j]*n % size];
+                }
+                values_[j] = sum / QReal(size);
+            }
+        }
+        shifts_ = 0;
+    }
+
+    Frame frame_;
+    QVector<int> bins_;
+    QVector<double> window_;
+    QVector<int> tracked_;
+    QVector<int> neighbours_;
+    QVector<QComplex> exponents_;
+    QVector<QComplex> rotations_;
+    QVector<QComplex> values_;
+    int shifts_ = 0;
+};
+
 class QAbstractWindow {
 public:
     virtual ~QAbstractWindow() = default;
@@ -2005,6 +3560,235 @@ public:
     QRealSignal makeWindow(int size) const override { return generate(size); }
 };
 
+// Потоковое кратковременное преобразование Фурье. Сигнал подаётся
+// фрагментами произвольного размера, кадры размером fftSize, взвешенные
+// окном, берутся с шагом hop; неполный кадр сохраняется до поступления
+// следующего фрагмента. Спектры кадров записываются в двумерный буфер по
+// строкам (кадр i занимает отсчёты [i*fftSize, (i+1)*fftSize)), буфер и
+// рабочие буферы БПФ при повторных вызовах не перераспределяются.
+// Нормировка спектров совпадает с нормировкой прямого QFft.
+class QStft {
+public:
+    QStft(const QAbstractWindow& window, int fftSize, int hop);
+    // Возвращают количество кадров, записанных в frames
+    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+    int compute(const T& chunk, QComplexSignal& frames)
+    {
+        int count = this->append_(chunk);
+        frames.resize(count*fftSize_);
+        frames.setClock(chunk.clock());
+        this->process_(count, frames.data(), nullptr);
+        return count;
+    }
+    // Модули спектров кадров
+    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+    int computeMagnitude(const T& chunk, QRealSignal& frames)
+    {
+        int count = this->append_(chunk);
+        frames.resize(count*fftSize_);
+        frames.setClock(chunk.clock());
+        this->process_(count, nullptr, frames.data());
+        return count;
+    }
+    // Количество кадров, которое будет получено после поступления samples отсчётов
+    int frameCount(int samples) const;
+    // Отбрасывает накопленные отсчёты
+    void reset();
+    int fftSize() const { return fftSize_; }
+    int hop() const { return hop_; }
+private:
+    template<class T>
+    int append_(const T& chunk)
+    {
+        int count = this->frameCount(chunk.size());
+        int start = std::min(skip_, chunk.size());
+        skip_ -= start;
+        int offset = pending_.size();
+        pending_.resize(offset + chunk.size() - start);
+        std::copy(chunk.begin() + start, chunk.end(), pending_.begin() + offset);
+        return count;
+    }
+    void process_(int count, QComplex* frames, QReal* magnitudes);
+
+private:
+    int fftSize_;
+    int hop_;
+    // Количество отсчётов, которые нужно пропустить при шаге больше кадра
+    int skip_ = 0;
+    QRealSignal window_;
+    QVector<QComplex> pending_;
+    std::shared_ptr<const QFftPlan> plan_;
+    QFftWorkspace workspace_;
+};
+
+// Обратное кратковременное преобразование Фурье: кадры, полученные QStft с
+// теми же окном, размером и шагом, суммируются с перекрытием после
+// взвешивания окном и нормировки на сумму квадратов окна. Отсчёты, на которые
+// уже не влияют последующие кадры, выдаются сразу, по hop отсчётов на кадр.
+class QIstft {
+public:
+    QIstft(const QAbstractWindow& window, int fftSize, int hop);
+    // frames - спектры кадров, записанные по строкам. Возвращает количество
+    // отсчётов, записанных в result
+    int compute(const QComplexSignal& frames, QComplexSignal& result);
+    // Выдаёт оставшиеся отсчёты последнего кадра и сбрасывает состояние
+    int flush(QComplexSignal& result);
+    void reset();
+    int fftSize() const { return fftSize_; }
+    int hop() const { return hop_; }
+private:
+    int fftSize_;
+    int hop_;
+    QRealSignal window_;
+    QVector<QComplex> accumulator_;
+    QVector<QReal> normalization_;
+    std::shared_ptr<const QFftPlan> plan_;
+    QFftWorkspace workspace_;
+};
+
+// Оценка спектральной плотности мощности методом Уэлча: спектры кадров с
+// перекрытием, взвешенных окном, усредняются по мере поступления сигнала,
+// поэтому длинные записи обрабатываются без хранения всех кадров. Спектр
+// мощности нормирован на когерентное усиление окна (амплитуда тона не
+// зависит от окна), спектральная плотность - на эквивалентную шумовую
+// полосу окна (ENBW).
+class QWelchPsd {
+public:
+    // Linear - усреднение модулей спектров, Rms - усреднение мощности,
+    // MaxHold - максимум мощности по кадрам
+    enum class Averaging {Linear, Rms, MaxHold};
+
+    QWelchPsd(const QAbstractWindow& window, int fftSize, int overlap, Averaging averaging = Averaging::Rms);
+    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+    void append(const T& chunk)
+    {
+        if (chunk.hasClock()) {
+            clock_ = chunk.clock();
+        }
+        int count = stft_.computeMagnitude(chunk, magnitudes_);
+        this->accumulate_(count);
+    }
+    // Количество усреднённых кадров
+    int frameCount() const { return frameCount_; }
+    void reset();
+    // oneSided - односторонний спектр (N/2 + 1 отсчётов) для действительных
+    // сигналов, иначе отсчёты расположены так же, как в результате QFft
+    QRealSignal powerSpectrum(bool oneSided = false) const;
+    // Спектральная плотность мощности на 1 Гц, требует частоты дискретизации
+    QRealSignal psd(bool oneSided = false) const;
+    // Эквивалентная шумовая полоса окна в отсчётах спектра
+    double enbw() const;
+    int fftSize() const { return stft_.fftSize(); }
+    int overlap() const { return stft_.fftSize() - stft_.hop(); }
+    Averaging averaging() const { return averaging_; }
+private:
+    void accumulate_(int count);
+
+private:
+    QStft stft_;
+    Averaging averaging_;
+    QFrequency clock_;
+    // Сумма и сумма квадратов отсчётов окна
+    double windowSum_ = 0;
+    double windowPowerSum_ = 0;
+    QRealSignal magnitudes_;
+    QVector<double> accumulator_;
+    int frameCount_ = 0;
+};
+
+template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+QRealSignal welch(const T &signal, const QAbstractWindow& window, int fftSize, int overlap)
+{
+    QWelchPsd estimator(window, fftSize, overlap);
+    estimator.append(signal);
+    return estimator.psd(isRealSignalContainer<T>);
+}
+
+// Двумерное БПФ матрицы rows x columns, хранящейся в сигнале по строкам
+// (например, пачка импульсов x элементы дальности для получения карты
+// дальность-доплер). Выполняется БПФ строк, затем матрица транспонируется
+// блоками, помещающимися в кэш, и выполняется БПФ столбцов; результат
+// транспонируется обратно. Строки и столбцы распределяются между потоками
+// пула (см. setFftThreadCount). Нормировка как у QFft: прямое преобразование
+// делится на rows*columns, обратное - нет. Функции compute не изменяют
+// экземпляр, поэтому он может использоваться несколькими потоками
+// одновременно, если у каждого потока свой рабочий буфер.
+class QFft2d {
+public:
+    // Промежуточные матрицы двумерного БПФ. Буферы только увеличиваются,
+    // поэтому при повторных вычислениях с одним экземпляром память не
+    // выделяется. Экземпляр не должен использоваться несколькими потоками
+    // одновременно.
+    class Workspace {
+    public:
+        Workspace() = default;
+        explicit Workspace(const QFft2d& fft) { this->reserve(fft); }
+        void reserve(const QFft2d& fft);
+
+        // Буферы, используемые вызовами без явно переданного рабочего буфера
+        static Workspace& threadLocal();
+
+    private:
+        friend class QFft2d;
+        QVector<QComplex> buffer_;
+        QVector<QComplex> transposed_;
+    };
+
+    QFft2d(int rows, int columns, bool inverted = false);
+    // Окна умножаются на каждую строку (размер окна columns) и на каждый
+    // столбец (размер окна rows) перед преобразованием
+    void setRowWindow(const QAbstractWindow& window);
+    void setColumnWindow(const QAbstractWindow& window);
+    void resetWindows();
+    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+    QComplexSignal compute(const T& matrix) const
+    { return this->compute(matrix, Workspace::threadLocal()); }
+    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+    QComplexSignal compute(const T& matrix, Workspace& workspace) const
+    {
+        QComplexSignal result;
+        this->compute(matrix, result, workspace);
+        return result;
+    }
+    // Аргумент и результат могут совпадать
+    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+    void compute(const T& matrix, QComplexSignal& result) const
+    { this->compute(matrix, result, Workspace::threadLocal()); }
+    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+    void compute(const T& matrix, QComplexSignal& result, Workspace& workspace) const
+    {
+        if (matrix.size() != rows_*columns_) {
+            throw std::invalid_argument("Matrix size must be equal to rows*columns");
+        }
+        QFrequency clock = matrix.clock();
+        workspace.reserve(*this);
+        this->process_(matrix.data(), workspace);
+        result.resize(rows_*columns_);
+        result.setClock(clock);
+        detail::transpose(workspace.buffer_.constData(), result.data(), columns_, rows_);
+    }
+    template<class T, class = std::enable_if_t<isSignalContainer<T>>>
+    QComplexSignal operator()(const T& matrix) const
+    { return this->compute(matrix); }
+    int rows() const { return rows_; }
+    int columns() const { return columns_; }
+    bool inverted() const { return inverted_; }
+private:
+    // Результат в workspace.buffer_ транспонирован: columns x rows
+    template<class Input>
+    void process_(const Input* matrix, Workspace& workspace) const;
+
+private:
+    int rows_;
+    int columns_;
+    bool inverted_;
+    // Пустое окно - без взвешивания
+    QRealSignal rowWindow_;
+    QRealSignal columnWindow_;
+    std::shared_ptr<const QFftPlan> rowPlan_;
+    std::shared_ptr<const QFftPlan> columnPlan_;
+};
+
 namespace modulation {
 QRealSignal amplitude(const QRealSignal& source, double M, double normFreq, double U = 1.0, double phase = 0);
 QRealSignal frequency(const QRealSignal& source, double m, double normFreq, double U = 1.0, double phase = 0);